@@ -68,7 +68,9 @@ int main(int argc, char* argv[]) {
     std::string path_database; // путь к базе данных новостей
     std::string environmental_variable;
     std::string sert_file("curl-ca-bundle.crt");
+    std::string path_response_cache; // путь к кэшу ответов сервера
     bool is_use_day_off = true;
+    bool is_use_write_log = false; // писать новые дни через журнал, не мешая читателям хранилища
 
     if(!process_arguments(argc, argv,[&](const std::string &key, const std::string &value){
         if (key == "path_json" ||
@@ -80,11 +82,17 @@ int main(int argc, char* argv[]) {
         if(key == "path_database" || key == "pd") {
             path_database = value;
         } else
+        if(key == "response_cache" || key == "rc") {
+            path_response_cache = value;
+        } else
         if(key == "use_day_off" || key == "udo") {
             is_use_day_off = true;
         } else
         if(key == "not_use_day_off" || key == "nudo") {
             is_use_day_off = false;
+        } else
+        if(key == "write_log" || key == "wl") {
+            is_use_write_log = true;
         }
     })) {
         std::cerr << "Error! No parameters!" << std::endl;
@@ -113,6 +121,8 @@ int main(int argc, char* argv[]) {
             if(settings_json["environmental_variable"] != nullptr) environmental_variable = settings_json["environmental_variable"];
             if(settings_json["sert_file"] != nullptr) sert_file = settings_json["sert_file"];
             if(settings_json["use_day_off"] != nullptr) is_use_day_off = settings_json["use_day_off"];
+            if(settings_json["response_cache"] != nullptr) path_response_cache = settings_json["response_cache"];
+            if(settings_json["write_log"] != nullptr) is_use_write_log = settings_json["write_log"];
         }
         catch(...) {
             std::cerr << "Error, json file does not contain necessary objects!" << std::endl;
@@ -157,6 +167,13 @@ int main(int argc, char* argv[]) {
     std::cout << "start of download..." << std::endl;
 
     ForexprostoolsDataStore::DataStore iDataStore(path_database);
+    if(is_use_write_log) {
+        std::cout << "write log: " << path_database << ".wal" << std::endl;
+        if(iDataStore.set_write_log(true) != ForexprostoolsDataStore::OK) {
+            std::cerr << "Error! Failed to open the write log!" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     /* Определим начальное время загрузки данных
      * Если данные уже есть, обновим данные за последнюю неделю,
@@ -184,6 +201,18 @@ int main(int argc, char* argv[]) {
     stop_timestamp += SECONDS_IN_WEEK_X2;
     int err = xquotes_common::NO_INIT;
     ForexprostoolsApi api(sert_file);
+    if(path_response_cache.size() != 0) {
+        std::cout << "response cache: " << path_response_cache << std::endl;
+        api.set_response_cache(path_response_cache);
+    }
+    /* дни, для которых сервер уже вернул пустой список, повторно не запрашиваются */
+    ForexprostoolsApi::SyncCalendar calendar;
+    calendar.check_empty_day = [&](const xtime::timestamp_t timestamp) {
+        return iDataStore.check_empty_day(timestamp);
+    };
+    calendar.set_empty_day = [&](const xtime::timestamp_t timestamp) {
+        iDataStore.set_empty_day(timestamp);
+    };
     /* начинаем згрузку данных  через API */
     int err_download = api.download_and_save_all_data(
                 max_timestamp,
@@ -193,7 +222,8 @@ int main(int argc, char* argv[]) {
             const std::vector<ForexprostoolsApiEasy::News> &list_news,
             const xtime::timestamp_t timestamp) {
         /* запишем полученне данные в хранилище  */
-        err = iDataStore.write_news(list_news, timestamp);
+        std::vector<ForexprostoolsApiEasy::News> changed_news, removed_news;
+        err = iDataStore.write_news(list_news, timestamp, changed_news, removed_news);
         if(err != xquotes_common::OK) {
             std::cerr << "write error, code: " << err << "\r";
             return;
@@ -201,9 +231,12 @@ int main(int argc, char* argv[]) {
         std::cout
             << "downloaded data from https://sslecal2.forexprostools.com, date: "
             << xtime::get_str_date(timestamp)
-            << "\r";
-        iDataStore.save();
-    });
+            << " changed: " << changed_news.size()
+            << " removed: " << removed_news.size()
+            << "    \r";
+        /* журнал сам сохраняет каждый день, хранилище обновится при завершении */
+        if(!is_use_write_log && (changed_news.size() > 0 || removed_news.size() > 0)) iDataStore.save();
+    }, calendar);
     //iDataStore.save();
     std::cout << std::endl;
     if(err == xquotes_common::OK && err_download == ForexprostoolsApi::OK) {
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cctype>
+#include <cstdlib>
 #include <fstream>
 #include <ForexprostoolsDataStore.hpp>
 
@@ -8,21 +9,19 @@ using json = nlohmann::json;
 
 int main(int argc, char* argv[]) {
     std::string path_database = "..//..//storage//forexprostools.dat"; // путь к базе данных новостей
+    uint32_t num_threads = 0; // количество потоков, 0 - по количеству ядер
+    if(argc > 1) path_database = argv[1];
+    if(argc > 2) num_threads = std::atoi(argv[2]);
     ForexprostoolsDataStore::DataStore iNewsDataBase(path_database);
 
     std::cout << "find the number of unique news..." << std::endl;
 
-    std::map<std::string,uint64_t> unique_news;
     std::vector<std::pair<std::string,uint64_t>> array_unique_news;
     xtime::timestamp_t news_min_time = 0, news_max_time = 0;
     iNewsDataBase.get_min_max_timestamp(news_min_time, news_max_time);
-    xtime::for_days(news_min_time, news_max_time,[&](const xtime::timestamp_t &t){
-        std::vector<ForexprostoolsApiEasy::News> list_news;
-        iNewsDataBase.read_news(list_news, t);
-        for(size_t n = 0; n < list_news.size(); ++n) {
-            unique_news[list_news[n].name]++;
-        }
-    });
+    ForexprostoolsApiEasy::NewsStatistics statistics;
+    iNewsDataBase.get_statistics(news_min_time, news_max_time, statistics, num_threads);
+    const std::map<std::string,uint64_t> &unique_news = statistics.names;
 
     std::cout << "end" << std::endl;
     std::cout << "unique_news.size: " << unique_news.size() << std::endl;
@@ -48,6 +47,21 @@ int main(int argc, char* argv[]) {
     }
     fout << "total news: " << array_unique_news.size() << std::endl;
     fout.close();
+
+    std::cout << "days: " << statistics.num_days << " news: " << statistics.num_news << std::endl;
+    std::cout
+        << "previous: " << statistics.num_previous
+        << " actual: " << statistics.num_actual
+        << " forecast: " << statistics.num_forecast
+        << std::endl;
+    for(auto it = statistics.currencies.begin(); it != statistics.currencies.end(); ++it) {
+        std::cout << "currency " << it->first << ": " << it->second << std::endl;
+    }
+    for(auto it = statistics.volatility.begin(); it != statistics.volatility.end(); ++it) {
+        std::cout << "volatility " << it->first << ": " << it->second << std::endl;
+    }
+    for(auto it = statistics.years.begin(); it != statistics.years.end(); ++it) {
+        std::cout << "year " << it->first << ": " << it->second << std::endl;
+    }
     return 0;
 }
-
@@ -0,0 +1,116 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include <iostream>
+#include <cstdlib>
+#include <ForexprostoolsDataStore.hpp>
+
+#define PROGRAM_VERSION "1.0"
+#define PROGRAM_DATE "19.10.2026"
+
+/* обработать все аргументы */
+bool process_arguments(
+    const int argc,
+    char **argv,
+    std::function<void(
+        const std::string &key,
+        const std::string &value)> f) noexcept {
+    if(argc <= 1) return false;
+    bool is_error = true;
+    for(int i = 1; i < argc; ++i) {
+        std::string key = std::string(argv[i]);
+        if(key.size() > 0 && (key[0] == '-' || key[0] == '/')) {
+            uint32_t delim_offset = 0;
+            if(key.size() > 2 && (key.substr(2) == "--") == 0) delim_offset = 1;
+            std::string value;
+            if((i + 1) < argc) value = std::string(argv[i + 1]);
+            is_error = false;
+            f(key.substr(delim_offset), value);
+        }
+    }
+    return !is_error;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "forexprostools legacy import" << std::endl;
+    std::cout
+        << "version: " << PROGRAM_VERSION
+        << " date: " << PROGRAM_DATE
+        << std::endl << std::endl;
+
+    std::string path_legacy;    // директория старой базы данных (файлы ГОД_МЕСЯЦ_ДЕНЬ.json)
+    std::string path_database;  // путь к хранилищу новостей
+    uint32_t num_threads = 0;
+
+    if(!process_arguments(argc, argv,[&](const std::string &key, const std::string &value){
+        if(key == "path_legacy" || key == "pl") {
+            path_legacy = value;
+        } else
+        if(key == "path_database" || key == "pd") {
+            path_database = value;
+        } else
+        if(key == "threads" || key == "t") {
+            num_threads = std::atoi(value.c_str());
+        }
+    })) {
+        std::cerr << "Error! No parameters!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if(path_legacy.size() == 0 || path_database.size() == 0) {
+        std::cerr << "Error! The path to the legacy database or data store is incorrect!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "legacy path: " << path_legacy << std::endl;
+    std::cout << "path: " << path_database << std::endl;
+    std::cout << "start of import..." << std::endl;
+
+    ForexprostoolsDataStore::DataStore iDataStore(path_database);
+    int err = iDataStore.import_legacy_news(
+            path_legacy,
+            num_threads,
+            [&](const xtime::timestamp_t timestamp, const size_t index, const size_t size) {
+        std::cout
+            << "imported: " << xtime::get_str_date(timestamp)
+            << " (" << (index + 1) << "/" << size << ")"
+            << "\r";
+    });
+    std::cout << std::endl;
+
+    xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+    if(iDataStore.get_min_max_timestamp(min_timestamp, max_timestamp) == ForexprostoolsDataStore::OK) {
+        std::cout
+            << "date: "
+            << xtime::get_str_date(min_timestamp)
+            << " - "
+            << xtime::get_str_date(max_timestamp)
+            << std::endl;
+    }
+    if(err != ForexprostoolsDataStore::OK) {
+        std::cerr << "import error, code: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "import completed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include <iostream>
+#include <cstdlib>
+#include <ForexprostoolsNewsMask.hpp>
+
+#define PROGRAM_VERSION "1.0"
+#define PROGRAM_DATE "19.10.2026"
+
+/* обработать все аргументы */
+bool process_arguments(
+    const int argc,
+    char **argv,
+    std::function<void(
+        const std::string &key,
+        const std::string &value)> f) noexcept {
+    if(argc <= 1) return false;
+    bool is_error = true;
+    for(int i = 1; i < argc; ++i) {
+        std::string key = std::string(argv[i]);
+        if(key.size() > 0 && (key[0] == '-' || key[0] == '/')) {
+            uint32_t delim_offset = 0;
+            if(key.size() > 2 && (key.substr(2) == "--") == 0) delim_offset = 1;
+            std::string value;
+            if((i + 1) < argc) value = std::string(argv[i + 1]);
+            is_error = false;
+            f(key.substr(delim_offset), value);
+        }
+    }
+    return !is_error;
+}
+
+
+int main(int argc, char* argv[]) {
+    std::cout << "forexprostools news mask generator" << std::endl;
+    std::cout
+        << "version: " << PROGRAM_VERSION
+        << " date: " << PROGRAM_DATE
+        << std::endl << std::endl;
+
+    std::string path_database;  // путь к хранилищу новостей
+    std::string path_mask;      // путь к файлу маски
+    ForexprostoolsDataStore::NewsMaskConfig config;
+    std::string volatility("h"); // уровни силы новостей: l - слабые, m - средние, h - сильные
+
+    if(!process_arguments(argc, argv,[&](const std::string &key, const std::string &value){
+        if(key == "path_database" || key == "pd") {
+            path_database = value;
+        } else
+        if(key == "path_mask" || key == "pm") {
+            path_mask = value;
+        } else
+        if(key == "pair" || key == "p") {
+            config.pair_name = value;
+        } else
+        if(key == "indent_past" || key == "ip") {
+            config.indent_past = std::atoi(value.c_str()) * xtime::SECONDS_IN_MINUTE;
+        } else
+        if(key == "indent_future" || key == "if") {
+            config.indent_future = std::atoi(value.c_str()) * xtime::SECONDS_IN_MINUTE;
+        } else
+        if(key == "volatility" || key == "v") {
+            volatility = value;
+        } else
+        if(key == "only_select" || key == "os") {
+            config.is_only_select = true;
+        }
+    })) {
+        std::cerr << "Error! No parameters!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if(path_database.size() == 0 || path_mask.size() == 0 || config.pair_name.size() == 0) {
+        std::cerr << "Error! The path to the data store, mask file or pair name is incorrect!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    config.is_low = volatility.find('l') != std::string::npos;
+    config.is_moderate = volatility.find('m') != std::string::npos;
+    config.is_high = volatility.find('h') != std::string::npos;
+
+    std::cout << "path: " << path_database << std::endl;
+    std::cout << "mask: " << path_mask << std::endl;
+    std::cout
+        << "pair: " << config.pair_name
+        << " indent: " << (config.indent_past / xtime::SECONDS_IN_MINUTE)
+        << "/" << (config.indent_future / xtime::SECONDS_IN_MINUTE) << " min"
+        << " volatility: " << volatility
+        << (config.is_only_select ? " only select" : "")
+        << std::endl;
+
+    ForexprostoolsDataStore::DataStore iDataStore(path_database);
+    xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+    if(iDataStore.get_min_max_timestamp(min_timestamp, max_timestamp) != ForexprostoolsDataStore::OK) {
+        std::cerr << "Error! The data store is empty!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout
+        << "date: "
+        << xtime::get_str_date(min_timestamp)
+        << " - "
+        << xtime::get_str_date(max_timestamp)
+        << std::endl;
+
+    uint32_t num_updated_days = 0;
+    int err = ForexprostoolsDataStore::update_news_mask(
+        iDataStore,
+        path_mask,
+        config,
+        min_timestamp,
+        max_timestamp,
+        num_updated_days);
+    if(err != ForexprostoolsDataStore::OK) {
+        std::cerr << "mask error, code: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "updated days: " << num_updated_days << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include <iostream>
+#include <cstdlib>
+#include <ForexprostoolsBurstScheduler.hpp>
+#include <ForexprostoolsNewsRing.hpp>
+
+#define PROGRAM_VERSION "1.0"
+#define PROGRAM_DATE "19.10.2026"
+
+/* обработать все аргументы */
+bool process_arguments(
+    const int argc,
+    char **argv,
+    std::function<void(
+        const std::string &key,
+        const std::string &value)> f) noexcept {
+    if(argc <= 1) return false;
+    bool is_error = true;
+    for(int i = 1; i < argc; ++i) {
+        std::string key = std::string(argv[i]);
+        if(key.size() > 0 && (key[0] == '-' || key[0] == '/')) {
+            uint32_t delim_offset = 0;
+            if(key.size() > 2 && (key.substr(2) == "--") == 0) delim_offset = 1;
+            std::string value;
+            if((i + 1) < argc) value = std::string(argv[i + 1]);
+            is_error = false;
+            f(key.substr(delim_offset), value);
+        }
+    }
+    return !is_error;
+}
+
+
+int main(int argc, char* argv[]) {
+    std::cout << "forexprostools news publisher" << std::endl;
+    std::cout
+        << "version: " << PROGRAM_VERSION
+        << " date: " << PROGRAM_DATE
+        << std::endl << std::endl;
+
+    std::string ring_name("forexprostools-news");   // имя буфера в общей памяти
+    std::string sert_file("curl-ca-bundle.crt");    // файл сертификата
+    uint32_t interval_ms = 1000;                    // период опроса
+    uint64_t capacity = ForexprostoolsApiEasy::NewsRingFormat::DEFAULT_CAPACITY;
+    std::string path_database;                      // хранилище с расписанием новостей для опроса вокруг их выхода
+    ForexprostoolsDataStore::BurstConfig burst_config;
+
+    process_arguments(argc, argv,[&](const std::string &key, const std::string &value){
+        if(key == "name" || key == "n") {
+            ring_name = value;
+        } else
+        if(key == "interval" || key == "i") {
+            interval_ms = std::atoi(value.c_str());
+        } else
+        if(key == "capacity" || key == "c") {
+            capacity = std::atoi(value.c_str());
+        } else
+        if(key == "sert_file" || key == "sf") {
+            sert_file = value;
+        } else
+        if(key == "path_database" || key == "pd") {
+            path_database = value;
+        } else
+        if(key == "burst_interval" || key == "bi") {
+            burst_config.burst_interval_ms = std::atoi(value.c_str());
+        } else
+        if(key == "burst_after" || key == "ba") {
+            burst_config.burst_after_ms = std::atoi(value.c_str()) * 1000;
+        }
+    });
+
+    if(ring_name.size() == 0 || interval_ms == 0 || capacity == 0) {
+        std::cerr << "Error! The ring name, interval or capacity is incorrect!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ForexprostoolsApiEasy::NewsRingPublisher publisher;
+    int err = publisher.open(ring_name, capacity);
+    if(err == ForexprostoolsApiEasy::INVALID_PARAMETER) {
+        std::cerr << "ring error: a ring with another capacity already exists" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(err != ForexprostoolsApiEasy::OK) {
+        std::cerr << "ring error, code: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "ring: " << ring_name << " capacity: " << publisher.get_capacity() << std::endl;
+    std::cout << "interval: " << interval_ms << " ms" << std::endl;
+
+    ForexprostoolsApi api(sert_file);
+    ForexprostoolsApi::watch_callback_t callback = [&](const std::vector<ForexprostoolsApiEasy::News> &changed_news) {
+        publisher.publish(changed_news);
+        std::cout
+            << xtime::get_str_date_time(xtime::get_timestamp())
+            << " published: " << changed_news.size()
+            << std::endl;
+    };
+    std::unique_ptr<ForexprostoolsDataStore::DataStore> store;
+    std::unique_ptr<ForexprostoolsDataStore::BurstScheduler> scheduler;
+    if(path_database.size() > 0) {
+        /* часто опрашиваем только вокруг выхода сильных новостей из хранилища */
+        std::cout << "path: " << path_database << std::endl;
+        std::cout
+            << "burst: " << burst_config.burst_interval_ms << " ms"
+            << " after: " << (burst_config.burst_after_ms / 1000) << " s"
+            << std::endl;
+        burst_config.slow_interval_ms = interval_ms;
+        store.reset(new ForexprostoolsDataStore::DataStore(path_database));
+        scheduler.reset(new ForexprostoolsDataStore::BurstScheduler(*store, burst_config));
+        err = scheduler->start(api, callback);
+    } else {
+        err = api.start_watch(interval_ms, callback);
+    }
+    if(err != ForexprostoolsApi::OK) {
+        std::cerr << "watch error, code: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+    while(true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#include <iostream>
+#include <cstdlib>
+#include <csignal>
+#include <ForexprostoolsStoreServer.hpp>
+
+#define PROGRAM_VERSION "1.0"
+#define PROGRAM_DATE "19.10.2026"
+
+/* обработать все аргументы */
+bool process_arguments(
+    const int argc,
+    char **argv,
+    std::function<void(
+        const std::string &key,
+        const std::string &value)> f) noexcept {
+    if(argc <= 1) return false;
+    bool is_error = true;
+    for(int i = 1; i < argc; ++i) {
+        std::string key = std::string(argv[i]);
+        if(key.size() > 0 && (key[0] == '-' || key[0] == '/')) {
+            uint32_t delim_offset = 0;
+            if(key.size() > 2 && (key.substr(2) == "--") == 0) delim_offset = 1;
+            std::string value;
+            if((i + 1) < argc) value = std::string(argv[i + 1]);
+            is_error = false;
+            f(key.substr(delim_offset), value);
+        }
+    }
+    return !is_error;
+}
+
+#if !defined(_WIN32)
+ForexprostoolsDataStore::StoreServer *server = nullptr;
+
+void stop_server(int) {
+    if(server != nullptr) server->stop();
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    std::cout << "forexprostools news store daemon" << std::endl;
+    std::cout
+        << "version: " << PROGRAM_VERSION
+        << " date: " << PROGRAM_DATE
+        << std::endl << std::endl;
+#if defined(_WIN32)
+    std::cerr << "Error! Unix domain sockets are not supported on this platform!" << std::endl;
+    return EXIT_FAILURE;
+#else
+    std::string path_database;                              // путь к хранилищу новостей
+    std::string socket_path("/tmp/forexprostools.sock");    // путь к файлу сокета
+    bool is_write_log = false;                              // подхватывать новые дни из журнала записи
+    uint32_t update_period_ms = 1000;                       // период проверки журнала записи
+
+    if(!process_arguments(argc, argv,[&](const std::string &key, const std::string &value){
+        if(key == "path_database" || key == "pd") {
+            path_database = value;
+        } else
+        if(key == "socket" || key == "s") {
+            socket_path = value;
+        } else
+        if(key == "write_log" || key == "wl") {
+            is_write_log = true;
+        } else
+        if(key == "update_period" || key == "up") {
+            update_period_ms = std::atoi(value.c_str());
+        }
+    })) {
+        std::cerr << "Error! No parameters!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if(path_database.size() == 0 || socket_path.size() == 0) {
+        std::cerr << "Error! The path to the data store or socket is incorrect!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "path: " << path_database << std::endl;
+    std::cout << "socket: " << socket_path << std::endl;
+
+    ForexprostoolsDataStore::DataStore iDataStore(path_database);
+    ForexprostoolsDataStore::StoreServer iServer(iDataStore);
+    if(is_write_log) {
+        if(iDataStore.set_write_log(false) != ForexprostoolsDataStore::OK) {
+            std::cerr << "Error! Failed to open the write log lock!" << std::endl;
+            return EXIT_FAILURE;
+        }
+        iServer.set_update_period(update_period_ms);
+        std::cout << "write log: update every " << update_period_ms << " ms" << std::endl;
+    }
+    int err = iServer.listen(socket_path);
+    if(err != ForexprostoolsDataStore::OK) {
+        std::cerr << "socket error, code: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+    server = &iServer;
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+    std::signal(SIGPIPE, SIG_IGN);
+    iServer.run();
+    server = nullptr;
+    std::cout << "stop" << std::endl;
+    return EXIT_SUCCESS;
+#endif
+}
@@ -32,7 +32,22 @@
 #include <thread>
 #include <string>
 #include <vector>
+#include <deque>
+#include <set>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define FOREXPROSTOOLS_API_USE_COROUTINE
+#endif
 #include <ForexprostoolsApiEasy.hpp>
+#include <ForexprostoolsResponseCache.hpp>
+#include <ForexprostoolsByteScan.hpp>
 //#include <ForexprostoolsDataStore.hpp>
 //------------------------------------------------------------------------------
 class ForexprostoolsApi {
@@ -47,6 +62,45 @@ public:
         PARSER_ERROR = -4,              ///< Ошибка парсера
         SUBSTRING_NOT_FOUND = -5,       ///< Подстрока не найдена
         NOT_ALL_DATA_DOWNLOADED = -8,   ///< Скачены не все данные
+        REQUEST_CANCELED = -9,          ///< Запрос отменен
+    };
+
+    /// Результат асинхронной загрузки новостей
+    class AsyncResponse {
+    public:
+        int err = NO_INIT;                                      /**< Код ошибки */
+        std::vector<ForexprostoolsApiEasy::News> list_news;     /**< Список новостей */
+
+        AsyncResponse() {};
+    };
+
+    /// Функция обратного вызова асинхронной загрузки
+    typedef std::function<void(AsyncResponse &response)> async_callback_t;
+
+    /// Функция обратного вызова опроса текущего дня, получает новые и измененные новости
+    typedef std::function<void(const std::vector<ForexprostoolsApiEasy::News> &changed_news)> watch_callback_t;
+
+    /// План следующего опроса текущего дня
+    class WatchPlan {
+    public:
+        uint32_t interval_ms = 1000;    /**< Задержка до следующего опроса в миллисекундах */
+        std::vector<int> countries;     /**< Страны следующего запроса. Если список пуст, запрашиваются все страны */
+
+        WatchPlan() {};
+    };
+
+    /// Функция планирования опроса, вызывается из потока опроса перед каждым ожиданием
+    typedef std::function<void(WatchPlan &plan)> watch_schedule_t;
+
+    /// Календарь загрузки: дни, для которых уже известно, что новостей нет
+    class SyncCalendar {
+    public:
+        std::function<bool(const xtime::timestamp_t timestamp)> check_empty_day;   /**< Вернет true, если за день точно нет новостей. Такие дни не запрашиваются */
+        std::function<void(const xtime::timestamp_t timestamp)> set_empty_day;     /**< Запомнить день, для которого сервер вернул пустой список */
+        uint32_t immutable_days = 7;        /**< Пустыми запоминаются только дни старше этого возраста в днях, так как в календарь добавляются новые события */
+        uint32_t max_range_days = 7;        /**< Максимальное количество дней в одном запросе для участков без новостей */
+
+        SyncCalendar() {};
     };
 
 private:
@@ -54,6 +108,44 @@ private:
         //const int MAX_NUM_ATTEMPT = 10;                         /**< Максимальное количество попыток */
         std::string sert_file_;                                 /**< Имя файла сертефиката */
         std::vector<ForexprostoolsApiEasy::News> list_news_;    /**< Список новостей */
+        ForexprostoolsResponseCache::ResponseCache response_cache_; /**< Кэш ответов сервера */
+
+        /// Асинхронный запрос
+        class AsyncRequest {
+        public:
+            std::string request_body;                   /**< Тело запроса */
+            xtime::timestamp_t end_timestamp = 0;       /**< Метка времени конца периода запроса */
+            std::string buffer;                         /**< Сжатый ответ сервера */
+            char error_buffer[CURL_ERROR_SIZE];         /**< Текст ошибки CURL */
+            struct curl_slist *http_headers = NULL;     /**< Заголовки запроса */
+            CURL *curl = NULL;                          /**< Обработчик запроса */
+            async_callback_t callback;                  /**< Функция обратного вызова */
+
+            AsyncRequest() {
+                error_buffer[0] = '\0';
+            };
+        };
+
+        CURLM *curl_multi_ = NULL;                      /**< Обработчик асинхронных запросов */
+        std::thread async_thread_;                      /**< Поток цикла асинхронных запросов */
+        std::mutex async_mutex_;
+        std::condition_variable async_cv_;
+        std::deque<AsyncRequest*> async_queue_;         /**< Запросы, ожидающие запуска */
+        std::set<AsyncRequest*> async_active_;          /**< Запросы в curl_multi, доступны только из потока цикла */
+        std::atomic<bool> is_async_stop_;               /**< Флаг остановки цикла */
+        bool is_async_start_ = false;                   /**< Флаг запуска цикла */
+        const long ASYNC_WAIT_MS = 50;                  /**< Максимальное время ожидания событий сокетов */
+
+        std::thread watch_thread_;                      /**< Поток опроса текущего дня */
+        std::mutex watch_mutex_;
+        std::condition_variable watch_cv_;
+        bool is_watch_stop_ = false;                    /**< Флаг остановки опроса */
+        bool is_watch_start_ = false;                   /**< Флаг запуска опроса */
+
+        std::shared_ptr<std::atomic<bool>> is_alive_;   /**< Флаг существования объекта, общий с потоками опроса и запросов */
+
+        uint32_t parse_threads_ = 1;                    /**< Количество потоков разбора ответа */
+        const std::size_t PARSE_CHUNK_MIN_SIZE = 65536; /**< Минимальный размер участка таблицы для одного потока разбора */
 
         /** \brief Получить тело запроса
          * \param beg_timestamp временная метка начала экономических новостей
@@ -128,9 +220,9 @@ private:
                 const std::string &terminator_beg,
                 const std::string &terminator_end,
                 std::string &out) {
-            std::size_t beg_pos = word.find(terminator_beg, 0);
+            std::size_t beg_pos = ForexprostoolsApiEasy::find_bytes(word, terminator_beg, 0);
             if(beg_pos != std::string::npos) {
-                std::size_t end_pos = word.find(terminator_end, beg_pos + terminator_beg.size());
+                std::size_t end_pos = ForexprostoolsApiEasy::find_bytes(word, terminator_end, beg_pos + terminator_beg.size());
                 if(end_pos != std::string::npos) {
                     out = word.substr(beg_pos + terminator_beg.size(), end_pos - beg_pos - terminator_beg.size());
                     return OK;
@@ -153,11 +245,11 @@ private:
                 const std::string &terminator_beg,
                 const std::string &terminator_end,
                 std::string &out) {
-            std::size_t title_pos = word.find(title, 0);
+            std::size_t title_pos = ForexprostoolsApiEasy::find_bytes(word, title, 0);
             if(title_pos != std::string::npos) {
-                std::size_t beg_pos = word.find(terminator_beg, title_pos);
+                std::size_t beg_pos = ForexprostoolsApiEasy::find_bytes(word, terminator_beg, title_pos);
                 if(beg_pos != std::string::npos) {
-                    std::size_t end_pos = word.find(terminator_end, beg_pos + 1);
+                    std::size_t end_pos = ForexprostoolsApiEasy::find_bytes(word, terminator_end, beg_pos + 1);
                     if(end_pos != std::string::npos) {
                         out = word.substr(beg_pos + 1, end_pos - beg_pos - 1);
                         return OK;
@@ -167,18 +259,28 @@ private:
             return SUBSTRING_NOT_FOUND;
         }
 //------------------------------------------------------------------------------
-        int parse_response(
-                const std::string &response,
+        /** \brief Разобрать строки таблицы новостей
+         *
+         * Разбираются строки, которые заканчиваются до позиции stop_pos.
+         * Поиск разделителей ведется по всему тексту, поэтому результат для соседних
+         * участков, разделенных по концам строк таблицы, совпадает с разбором всего текста.
+         * \param text Текст таблицы
+         * \param start_pos Позиция сразу после конца строки таблицы или 0
+         * \param stop_pos Позиция сразу после конца строки таблицы или размер текста
+         * \param list_news Список новостей, новости добавляются в конец
+         * \return вернет 0 в случае успеха
+         */
+        int parse_rows(
+                const std::string &text,
+                const std::size_t start_pos,
+                const std::size_t stop_pos,
                 std::vector<ForexprostoolsApiEasy::News> &list_news) {
-            using json = nlohmann::json;
             try {
-                json j;
-                j = json::parse(response);
-                std::string text = j["renderedFilteredEvents"];
                 const std::string header_beg = "<tr";
                 const std::string header_end = "</tr>";
-                std::size_t start_data_pos = 0;
-                while(true) {
+                std::size_t start_data_pos = start_pos;
+                std::string part; // буфер строки таблицы, используется повторно
+                while(start_data_pos < stop_pos) {
                     ForexprostoolsApiEasy::News one_news;
                     const int STATE_TIME = 0x01;
                     const int STATE_NAME = 0x02;
@@ -186,11 +288,11 @@ private:
                     const int STATE_DATA = 0x08;
                     const int STATE_OK = 0x0F;
                     int state = 0;
-                    std::size_t beg_pos = text.find(header_beg, start_data_pos);
-                    std::size_t end_pos = text.find(header_end, start_data_pos);
+                    std::size_t beg_pos = ForexprostoolsApiEasy::find_bytes(text, header_beg, start_data_pos);
+                    std::size_t end_pos = ForexprostoolsApiEasy::find_bytes(text, header_end, start_data_pos);
                     if( beg_pos != std::string::npos &&
                         end_pos != std::string::npos) {
-                        std::string part = text.substr(beg_pos, end_pos - beg_pos);
+                        part.assign(text, beg_pos, end_pos - beg_pos);
                         start_data_pos = end_pos + header_end.size();
                         // парсим part
                         const std::string str_event_timestamp = "event_timestamp=";
@@ -216,21 +318,21 @@ private:
                         std::string str_previous, str_actual, str_forecast;
 
                         if(find_substring(part, str_event_previous, str_div_beg, str_div_end, str_previous) == OK) {
-                            if(str_previous.find(str_nbsp, 0) == std::string::npos) {
+                            if(ForexprostoolsApiEasy::find_bytes(str_previous, str_nbsp, 0) == std::string::npos) {
                                 one_news.previous = atof(str_previous.c_str());
                                 one_news.is_previous = true;
                             }
                             state |= STATE_DATA;
                         }
                         if(find_substring(part, str_event_actual, str_div_beg, str_div_end, str_actual) == OK) {
-                            if(str_actual.find(str_nbsp, 0) == std::string::npos) {
+                            if(ForexprostoolsApiEasy::find_bytes(str_actual, str_nbsp, 0) == std::string::npos) {
                                 one_news.actual = atof(str_actual.c_str());
                                 one_news.is_actual = true;
                             }
                             state |= STATE_DATA;
                         }
                         if(find_substring(part, str_event_forecast, str_div_beg, str_div_end, str_forecast) == OK) {
-                            if(str_forecast.find(str_nbsp, 0) == std::string::npos) {
+                            if(ForexprostoolsApiEasy::find_bytes(str_forecast, str_nbsp, 0) == std::string::npos) {
                                 one_news.forecast = atof(str_forecast.c_str());
                                 one_news.is_forecast = true;
                             }
@@ -244,15 +346,15 @@ private:
                             const std::string str_low = "Low";
                             const std::string str_moderate = "Moderate";
                             const std::string str_high = "High";
-                            if(str_sentiment.find(str_low, 0) != std::string::npos) {
+                            if(ForexprostoolsApiEasy::find_bytes(str_sentiment, str_low, 0) != std::string::npos) {
                                 one_news.level_volatility = ForexprostoolsApiEasy::LOW;
                                 state |= STATE_VOL;
                             } else
-                            if(str_sentiment.find(str_moderate, 0) != std::string::npos) {
+                            if(ForexprostoolsApiEasy::find_bytes(str_sentiment, str_moderate, 0) != std::string::npos) {
                                 one_news.level_volatility = ForexprostoolsApiEasy::MODERATE;
                                 state |= STATE_VOL;
                             } else
-                            if(str_sentiment.find(str_high, 0) != std::string::npos) {
+                            if(ForexprostoolsApiEasy::find_bytes(str_sentiment, str_high, 0) != std::string::npos) {
                                 one_news.level_volatility = ForexprostoolsApiEasy::HIGH;
                                 state |= STATE_VOL;
                             }
@@ -263,7 +365,7 @@ private:
                         const std::string str_left_event_div_end = "<";
                         std::string str_left_event;
                         if(find_substring(part, str_left_event_div_beg, str_left_event_div_end, str_left_event) == OK) {
-                            std::size_t nbsp_pos = str_left_event.find(str_nbsp, 0);
+                            std::size_t nbsp_pos = ForexprostoolsApiEasy::find_bytes(str_left_event, str_nbsp, 0);
                             if(nbsp_pos != std::string::npos) {
                                 str_left_event.erase(nbsp_pos, str_nbsp.length());
                             }
@@ -295,19 +397,19 @@ private:
                         // определяем страну валюты
                         const std::string str_flag_div_beg = "<td class=\"left flagCur noWrap\">";
                         const std::string str_flag_div_end = "</td>";
-                        std::size_t flag_beg_pos = part.find(str_flag_div_beg, 0);
+                        std::size_t flag_beg_pos = ForexprostoolsApiEasy::find_bytes(part, str_flag_div_beg, 0);
                         if(flag_beg_pos != std::string::npos) {
-                            std::size_t flag_end_pos = part.find(str_flag_div_end, flag_beg_pos + str_flag_div_beg.size());
+                            std::size_t flag_end_pos = ForexprostoolsApiEasy::find_bytes(part, str_flag_div_end, flag_beg_pos + str_flag_div_beg.size());
                             if(flag_end_pos != std::string::npos) {
                                 const std::string str_title = "title=";
                                 const std::string str_currency_beg = "</span>";
 
-                                std::size_t title_pos = part.find(str_title, flag_beg_pos + str_flag_div_beg.size());
+                                std::size_t title_pos = ForexprostoolsApiEasy::find_bytes(part, str_title, flag_beg_pos + str_flag_div_beg.size());
                                 if(title_pos != std::string::npos) {
                                     const std::string str_div_timestamp = "\"";
-                                    std::size_t beg_pos = part.find(str_div_timestamp, title_pos);
+                                    std::size_t beg_pos = ForexprostoolsApiEasy::find_bytes(part, str_div_timestamp, title_pos);
                                     if(beg_pos != std::string::npos) {
-                                        std::size_t end_pos = part.find(str_div_timestamp, beg_pos + 1);
+                                        std::size_t end_pos = ForexprostoolsApiEasy::find_bytes(part, str_div_timestamp, beg_pos + 1);
                                         if(end_pos != std::string::npos) {
                                             // имя страны
                                             one_news.country = part.substr(beg_pos + 1, end_pos - beg_pos - 1);
@@ -316,7 +418,7 @@ private:
                                     } // if
                                 }
 
-                                std::size_t currency_pos = part.find(str_currency_beg, flag_beg_pos + str_flag_div_beg.size());
+                                std::size_t currency_pos = ForexprostoolsApiEasy::find_bytes(part, str_currency_beg, flag_beg_pos + str_flag_div_beg.size());
                                 if(currency_pos != std::string::npos) {
                                     // имя валюты
                                     std::string str_currency = part.substr(currency_pos + str_currency_beg.size(), flag_end_pos - currency_pos - str_currency_beg.size());
@@ -327,7 +429,7 @@ private:
                             } // if
                         } // if
                         if(state == STATE_OK) {
-                            list_news.push_back(one_news);
+                            list_news.push_back(std::move(one_news));
                         }
                     } else {
                         break;
@@ -340,6 +442,69 @@ private:
             return OK;
         }
 
+        /** \brief Разобрать ответ сервера
+         *
+         * Если задано несколько потоков разбора (set_parse_threads) и таблица большая,
+         * текст делится на участки по концам строк таблицы, участки разбираются параллельно
+         * и объединяются по порядку. Результат совпадает с разбором в одном потоке.
+         * \param response Ответ сервера
+         * \param list_news Список новостей, новости добавляются в конец
+         * \return вернет 0 в случае успеха
+         */
+        int parse_response(
+                const std::string &response,
+                std::vector<ForexprostoolsApiEasy::News> &list_news) {
+            using json = nlohmann::json;
+            std::string text;
+            try {
+                json j;
+                j = json::parse(response);
+                text = j["renderedFilteredEvents"];
+            }
+            catch(...) {
+                return PARSER_ERROR;
+            }
+
+            uint32_t num_threads = parse_threads_;
+            if(num_threads == 0) num_threads = std::max(1U, std::thread::hardware_concurrency());
+            num_threads = (uint32_t)std::min((std::size_t)num_threads, text.size() / PARSE_CHUNK_MIN_SIZE);
+            if(num_threads <= 1) return parse_rows(text, 0, text.size(), list_news);
+
+            /* участки заканчиваются сразу после </tr>, там же, где начинается следующий шаг разбора в одном потоке */
+            const std::string header_end = "</tr>";
+            std::vector<std::size_t> bounds(1, 0);
+            const std::size_t chunk_size = text.size() / num_threads;
+            for(uint32_t n = 1; n < num_threads; ++n) {
+                const std::size_t pos = ForexprostoolsApiEasy::find_bytes(text, header_end, std::max(bounds.back(), n * chunk_size));
+                if(pos == std::string::npos) break;
+                bounds.push_back(pos + header_end.size());
+            }
+            bounds.push_back(text.size());
+
+            const std::size_t num_chunks = bounds.size() - 1;
+            std::vector<std::vector<ForexprostoolsApiEasy::News>> chunks(num_chunks);
+            std::vector<int> list_err(num_chunks, OK);
+            std::vector<std::thread> workers;
+            for(std::size_t n = 1; n < num_chunks; ++n) {
+                workers.push_back(std::thread([&, n]() {
+                    list_err[n] = parse_rows(text, bounds[n], bounds[n + 1], chunks[n]);
+                }));
+            }
+            list_err[0] = parse_rows(text, bounds[0], bounds[1], chunks[0]);
+            for(std::size_t n = 0; n < workers.size(); ++n) {
+                workers[n].join();
+            }
+            /* при ошибке, как и в одном потоке, остаются новости до места ошибки */
+            std::size_t num_news = 0;
+            for(std::size_t n = 0; n < num_chunks; ++n) num_news += chunks[n].size();
+            list_news.reserve(list_news.size() + num_news);
+            for(std::size_t n = 0; n < num_chunks; ++n) {
+                std::move(chunks[n].begin(), chunks[n].end(), std::back_inserter(list_news));
+                if(list_err[n] != OK) return list_err[n];
+            }
+            return OK;
+        }
+
         static int writer(char *data, size_t size, size_t nmemb, std::string *buffer) {
             int result = 0;
             if (buffer != NULL) {
@@ -349,19 +514,31 @@ private:
             return result;
         }
 
-        int do_post_request(
+        /** \brief Подготовить POST запрос
+         *
+         * Тело запроса, буфер ответа и буфер ошибки должны существовать до завершения запроса.
+         * \param request_body Тело запроса
+         * \param buffer Буфер для сжатого ответа сервера
+         * \param error_buffer Буфер для текста ошибки размером CURL_ERROR_SIZE
+         * \param http_headers Заголовки запроса. После завершения запроса их нужно освободить через curl_slist_free_all
+         * \param sert_file Файл сертификата
+         * \return Указатель на CURL или NULL в случае ошибки
+         */
+        CURL *init_post_request(
                 const std::string &request_body,
-                std::string &out,
+                std::string &buffer,
+                char *error_buffer,
+                struct curl_slist *&http_headers,
                 const std::string &sert_file) {
             CURL *curl;
             curl = curl_easy_init();
             if(!curl) {
-                return INIT_ERROR;
+                return NULL;
             }
             const std::string url = ("https://sslecal2.forexprostools.com/ajax.php");
-            char error_buffer[CURL_ERROR_SIZE];
             const int TIME_OUT = 60;
-            std::string buffer;
+            buffer.clear();
+            error_buffer[0] = '\0';
 
             curl_easy_setopt(curl, CURLOPT_POST, 1); // делаем пост запрос
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
@@ -372,7 +549,7 @@ private:
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writer);
             curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
 
-            struct curl_slist *http_headers = NULL;
+            http_headers = NULL;
             http_headers = curl_slist_append(http_headers, "Host: sslecal2.forexprostools.com");
             http_headers = curl_slist_append(http_headers, "Accept: application/json, text/javascript, */*; q=0.01");
             http_headers = curl_slist_append(http_headers, "Accept-Language: ru-RU,ru;q=0.8,en-US;q=0.5,en;q=0.3");
@@ -385,6 +562,25 @@ private:
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, http_headers);
             curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_body.c_str());
             curl_easy_setopt(curl, CURLOPT_TIMEOUT, TIME_OUT);
+            return curl;
+        }
+
+        /** \brief Выполнить POST запрос без распаковки ответа
+         * \param request_body Тело запроса
+         * \param buffer Сжатый ответ сервера
+         * \param sert_file Файл сертификата
+         * \return Вернет 0 в случае успеха
+         */
+        int do_post_request_raw(
+                const std::string &request_body,
+                std::string &buffer,
+                const std::string &sert_file) {
+            char error_buffer[CURL_ERROR_SIZE];
+            struct curl_slist *http_headers = NULL;
+            CURL *curl = init_post_request(request_body, buffer, error_buffer, http_headers, sert_file);
+            if(!curl) {
+                return INIT_ERROR;
+            }
 
             CURLcode result;
             result = curl_easy_perform(curl);
@@ -392,18 +588,306 @@ private:
             http_headers = NULL;
 
             curl_easy_cleanup(curl);
-            if(result == CURLE_OK) {
-                try {
-                    const char *compressed_pointer = buffer.data();
-                    out = gzip::decompress(compressed_pointer, buffer.size());
+            if(result == CURLE_OK) return OK;
+            std::cerr << "Error: [" << result << "] - " << error_buffer;
+            return result;
+        }
+
+        /** \brief Распаковать ответ сервера
+         * \param buffer Сжатый ответ сервера
+         * \param out Распакованный ответ
+         * \return Вернет 0 в случае успеха
+         */
+        int decompress_response(const std::string &buffer, std::string &out) {
+            try {
+                const char *compressed_pointer = buffer.data();
+                out = gzip::decompress(compressed_pointer, buffer.size());
+            }
+            catch(...) {
+                return DECOMPRESSION_ERROR;
+            }
+            return OK;
+        }
+
+        int do_post_request(
+                const std::string &request_body,
+                std::string &out,
+                const std::string &sert_file) {
+            std::string buffer;
+            int err = do_post_request_raw(request_body, buffer, sert_file);
+            if(err != OK) return err;
+            return decompress_response(buffer, out);
+        }
+
+        /** \brief Получить ответ сервера с учетом кэша ответов
+         * \param request_body Тело запроса
+         * \param end_timestamp Метка времени конца периода запроса
+         * \param out Распакованный ответ
+         * \return Вернет 0 в случае успеха
+         */
+        int get_response(
+                const std::string &request_body,
+                const xtime::timestamp_t end_timestamp,
+                std::string &out) {
+            if(!response_cache_.is_use()) return do_post_request(request_body, out, sert_file_);
+            std::string buffer;
+            if(response_cache_.get(request_body, buffer) &&
+                decompress_response(buffer, out) == OK) return OK;
+            int err = do_post_request_raw(request_body, buffer, sert_file_);
+            if(err != OK) return err;
+            err = decompress_response(buffer, out);
+            if(err != OK) return err;
+            response_cache_.put(request_body, end_timestamp, buffer);
+            return OK;
+        }
+//------------------------------------------------------------------------------
+        /** \brief Завершить асинхронный запрос
+         * \param request Асинхронный запрос
+         * \param err Код ошибки запроса
+         */
+        void finish_async_request(AsyncRequest *request, int err) {
+            AsyncResponse response;
+            if(err == OK) {
+                std::string text;
+                err = decompress_response(request->buffer, text);
+                if(err == OK) {
+                    response_cache_.put(request->request_body, request->end_timestamp, request->buffer);
+                    err = parse_response(text, response.list_news);
                 }
-                catch(...) {
-                    return DECOMPRESSION_ERROR;
+            }
+            response.err = err;
+            if(request->curl != NULL) {
+                curl_multi_remove_handle(curl_multi_, request->curl);
+                curl_easy_cleanup(request->curl);
+                request->curl = NULL;
+            }
+            if(request->http_headers != NULL) {
+                curl_slist_free_all(request->http_headers);
+                request->http_headers = NULL;
+            }
+            if(request->callback != nullptr) request->callback(response);
+            delete request;
+        }
+
+        /** \brief Запустить запрос в цикле асинхронных запросов
+         * \param request Асинхронный запрос
+         * \return Вернет true, если запрос передан в curl_multi
+         */
+        bool start_async_request(AsyncRequest *request) {
+            /* сначала пробуем взять ответ из кэша */
+            if(response_cache_.get(request->request_body, request->buffer)) {
+                finish_async_request(request, OK);
+                return false;
+            }
+            request->curl = init_post_request(
+                request->request_body,
+                request->buffer,
+                request->error_buffer,
+                request->http_headers,
+                sert_file_);
+            if(request->curl == NULL) {
+                finish_async_request(request, INIT_ERROR);
+                return false;
+            }
+            curl_easy_setopt(request->curl, CURLOPT_PRIVATE, request);
+            if(curl_multi_add_handle(curl_multi_, request->curl) != CURLM_OK) {
+                curl_easy_cleanup(request->curl);
+                request->curl = NULL;
+                finish_async_request(request, INIT_ERROR);
+                return false;
+            }
+            return true;
+        }
+
+        /** \brief Отменить все незавершенные асинхронные запросы
+         *
+         * Вызывается только из потока цикла асинхронных запросов.
+         */
+        void cancel_async_requests() {
+            std::deque<AsyncRequest*> canceled_requests;
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                canceled_requests.swap(async_queue_);
+            }
+            canceled_requests.insert(canceled_requests.end(), async_active_.begin(), async_active_.end());
+            async_active_.clear();
+            for(size_t i = 0; i < canceled_requests.size(); ++i) {
+                finish_async_request(canceled_requests[i], REQUEST_CANCELED);
+            }
+        }
+
+        /** \brief Цикл асинхронных запросов
+         *
+         * Все запросы обслуживаются одним потоком через curl_multi.
+         * Если объект API удален из функции обратного вызова, деструктор сам отменяет
+         * оставшиеся запросы, а цикл завершается сразу после возврата из функции.
+         * \param is_alive Флаг существования объекта API
+         */
+        void async_loop(std::shared_ptr<std::atomic<bool>> is_alive) {
+            int running_handles = 0;
+            while(true) {
+                AsyncRequest *request = NULL;
+                {
+                    std::unique_lock<std::mutex> lock(async_mutex_);
+                    if(async_active_.empty()) {
+                        async_cv_.wait(lock, [&]{
+                            return is_async_stop_ || !async_queue_.empty();
+                        });
+                    }
+                    if(is_async_stop_) break;
+                    if(!async_queue_.empty()) {
+                        request = async_queue_.front();
+                        async_queue_.pop_front();
+                    }
+                }
+                if(request != NULL) {
+                    if(start_async_request(request)) {
+                        async_active_.insert(request);
+                    }
+                    if(!*is_alive) return;
+                    continue;
+                }
+                if(async_active_.empty()) continue;
+
+                curl_multi_perform(curl_multi_, &running_handles);
+                CURLMsg *msg = NULL;
+                int msgs_left = 0;
+                while((msg = curl_multi_info_read(curl_multi_, &msgs_left)) != NULL) {
+                    if(msg->msg != CURLMSG_DONE) continue;
+                    char *private_pointer = NULL;
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &private_pointer);
+                    request = reinterpret_cast<AsyncRequest*>(private_pointer);
+                    if(request == NULL) continue;
+                    const CURLcode result = msg->data.result;
+                    if(result != CURLE_OK) {
+                        std::cerr << "Error: [" << result << "] - " << request->error_buffer;
+                    }
+                    async_active_.erase(request);
+                    finish_async_request(request, result == CURLE_OK ? (int)OK : (int)result);
+                    if(!*is_alive) return;
+                }
+                if(running_handles > 0) {
+                    int numfds = 0;
+#                   if LIBCURL_VERSION_NUM >= 0x074400
+                    curl_multi_poll(curl_multi_, NULL, 0, ASYNC_WAIT_MS, &numfds);
+#                   else
+                    curl_multi_wait(curl_multi_, NULL, 0, ASYNC_WAIT_MS, &numfds);
+#                   endif
                 }
-                return OK;
             }
-            std::cerr << "Error: [" << result << "] - " << error_buffer;
-            return result;
+            cancel_async_requests();
+        }
+
+        /** \brief Разбудить цикл асинхронных запросов
+         */
+        void wakeup_async_loop() {
+            async_cv_.notify_one();
+#           if LIBCURL_VERSION_NUM >= 0x074400
+            if(curl_multi_ != NULL) curl_multi_wakeup(curl_multi_);
+#           endif
+        }
+
+        /** \brief Запустить цикл асинхронных запросов, если он еще не запущен
+         * \return Вернет 0 в случае успеха
+         */
+        int init_async_loop() {
+            std::lock_guard<std::mutex> lock(async_mutex_);
+            if(is_async_start_) return OK;
+            curl_multi_ = curl_multi_init();
+            if(curl_multi_ == NULL) return INIT_ERROR;
+            is_async_stop_ = false;
+            async_thread_ = std::thread(&ForexprostoolsApi::async_loop, this, is_alive_);
+            is_async_start_ = true;
+            return OK;
+        }
+//------------------------------------------------------------------------------
+        /** \brief Цикл опроса текущего дня
+         *
+         * Запросы выполняются через один обработчик CURL, поэтому соединение с сервером
+         * не закрывается между опросами. Если сжатый ответ совпадает с предыдущим,
+         * он не распаковывается и не разбирается, а буферы ответов используются повторно.
+         * Новости сравниваются со всеми уже известными новостями дня, поэтому запрос
+         * только части стран не приводит к повторной выдаче остальных новостей.
+         * Если объект API удален из функции обратного вызова или планирования,
+         * цикл завершается сразу после возврата из нее и больше не обращается к объекту.
+         * \param schedule Функция планирования опроса
+         * \param callback Функция обратного вызова
+         * \param is_alive Флаг существования объекта API
+         */
+        void watch_loop(
+                watch_schedule_t schedule,
+                watch_callback_t callback,
+                std::shared_ptr<std::atomic<bool>> is_alive) {
+            char error_buffer[CURL_ERROR_SIZE];
+            struct curl_slist *http_headers = NULL;
+            CURL *curl = NULL;
+            std::string request_body;
+            std::string buffer, last_buffer;    // сжатые ответы сервера
+            std::string text, last_text;        // распакованные ответы сервера
+            std::vector<ForexprostoolsApiEasy::News> list_news, known_news;
+            std::vector<ForexprostoolsApiEasy::News> changed_news, removed_news;
+            xtime::timestamp_t day_timestamp = 0;
+            std::vector<int> countries;
+            WatchPlan plan;
+            schedule(plan);
+            while(true) {
+                /* при смене дня или стран меняем тело запроса, соединение остается прежним */
+                const xtime::timestamp_t timestamp = xtime::get_first_timestamp_day(xtime::get_timestamp());
+                if(curl == NULL || timestamp != day_timestamp || countries != plan.countries) {
+                    if(timestamp != day_timestamp) known_news.clear();
+                    day_timestamp = timestamp;
+                    countries = plan.countries;
+                    request_body = get_request_body(day_timestamp, day_timestamp + xtime::SECONDS_IN_DAY - 1, countries);
+                    if(curl == NULL) {
+                        curl = init_post_request(request_body, buffer, error_buffer, http_headers, sert_file_);
+                        if(curl != NULL) curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+                    } else {
+                        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_body.c_str());
+                    }
+                    last_buffer.clear();
+                    last_text.clear();
+                }
+                if(curl != NULL) {
+                    buffer.clear();
+                    error_buffer[0] = '\0';
+                    const CURLcode result = curl_easy_perform(curl);
+                    if(result != CURLE_OK) {
+                        std::cerr << "Error: [" << result << "] - " << error_buffer;
+                    } else
+                    if(buffer != last_buffer) {
+                        buffer.swap(last_buffer);
+                        if(decompress_response(last_buffer, text) != OK) {
+                            last_buffer.clear();
+                        } else
+                        if(text != last_text) {
+                            text.swap(last_text);
+                            list_news.clear();
+                            if(parse_response(last_text, list_news) != OK) {
+                                last_buffer.clear();
+                                last_text.clear();
+                            } else {
+                                ForexprostoolsApiEasy::compare_news(known_news, list_news, changed_news, removed_news);
+                                if(!changed_news.empty()) {
+                                    /* новости, которых нет в ответе, остаются известными */
+                                    list_news.insert(list_news.end(), removed_news.begin(), removed_news.end());
+                                    list_news.swap(known_news);
+                                    callback(changed_news);
+                                    if(!*is_alive) break;
+                                }
+                            }
+                        }
+                    }
+                }
+                if(!*is_alive) break;
+                schedule(plan);
+                if(!*is_alive) break;
+                std::unique_lock<std::mutex> lock(watch_mutex_);
+                if(watch_cv_.wait_for(lock, std::chrono::milliseconds(plan.interval_ms), [&]{
+                        return is_watch_stop_;
+                    })) break;
+            }
+            if(curl != NULL) curl_easy_cleanup(curl);
+            if(http_headers != NULL) curl_slist_free_all(http_headers);
         }
 //------------------------------------------------------------------------------
 public:
@@ -430,6 +914,39 @@ public:
             India = 14,
             Switzerland = 12,
         };
+
+        /** \brief Получить код страны для запроса
+         * \param country Имя страны, как в поле News::country (например, United States)
+         * \return Код страны из CounryCode или 0, если страна неизвестна
+         */
+        static int get_country_code(const std::string &country) {
+            static const std::unordered_map<std::string, int> codes = {
+                {"Italy", Italy},
+                {"South Korea", South_Korea},
+                {"Germany", Germany},
+                {"France", France},
+                {"Australia", Australia},
+                {"Spain", Spain},
+                {"Brazil", Brazil},
+                {"Japan", Japan},
+                {"Singapore", Singapore},
+                {"China", China},
+                {"Austria", Austria},
+                {"Russia", Russia},
+                {"Euro Zone", Euro_Zone},
+                {"United Kingdom", United_Kingdom},
+                {"United States", United_States},
+                {"Canada", Canada},
+                {"South Africa", South_Africa},
+                {"Hong Kong", Hong_Kong},
+                {"New Zealand", New_Zealand},
+                {"India", India},
+                {"Switzerland", Switzerland},
+            };
+            auto it = codes.find(country);
+            if(it == codes.end()) return 0;
+            return it->second;
+        }
 //------------------------------------------------------------------------------
         ForexprostoolsApi(const std::string &sert_file = std::string("curl-ca-bundle.crt")) {
             /* Должен инициализировать libcurl до запуска любых потоков */
@@ -437,6 +954,67 @@ public:
                 is_curl_global_init_error_ = true;
             }
             sert_file_ = sert_file;
+            is_async_stop_ = false;
+            is_alive_ = std::make_shared<std::atomic<bool>>(true);
+        }
+
+        ~ForexprostoolsApi() {
+            stop_watch();
+            /* при удалении из потока опроса он не может дождаться сам себя и завершится после возврата из функции обратного вызова */
+            if(watch_thread_.joinable()) watch_thread_.detach();
+            bool is_start = false;
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                is_start = is_async_start_;
+                is_async_stop_ = true;
+            }
+            if(!is_start) {
+                *is_alive_ = false;
+                return;
+            }
+            if(std::this_thread::get_id() == async_thread_.get_id()) {
+                /* удаление из функции обратного вызова или продолжения асинхронного запроса:
+                 * поток не может дождаться сам себя, поэтому отменяем запросы здесь */
+                cancel_async_requests();
+                async_thread_.detach();
+            } else {
+                wakeup_async_loop();
+                async_thread_.join();
+            }
+            *is_alive_ = false;
+            curl_multi_cleanup(curl_multi_);
+            curl_multi_ = NULL;
+        }
+//------------------------------------------------------------------------------
+        /** \brief Включить дисковый кэш ответов сервера
+         *
+         * Ответы за дни, которые на момент загрузки были старше immutable_days,
+         * на сервере уже не меняются и всегда читаются из кэша без сетевых запросов.
+         * Это позволяет, например, заново разобрать всю историю после исправления парсера.
+         * Кэш читается потоком асинхронных запросов без блокировки, поэтому его нужно включить
+         * до первого асинхронного запроса и не вызывать метод одновременно с get_response.
+         * \param path Директория кэша
+         * \param immutable_days Возраст дня в днях, после которого ответ считается неизменяемым
+         * \param max_age Время жизни в секундах ответов за недавние дни. Если 0, такие ответы всегда загружаются заново
+         * \return вернет 0 в случае успеха или INIT_ERROR, если цикл асинхронных запросов уже запущен
+         */
+        int set_response_cache(
+                const std::string &path,
+                const uint32_t immutable_days = 30,
+                const xtime::timestamp_t max_age = 0) {
+            std::lock_guard<std::mutex> lock(async_mutex_);
+            if(is_async_start_) return INIT_ERROR;
+            response_cache_.set(path, immutable_days, max_age);
+            return OK;
+        }
+
+        /** \brief Установить количество потоков разбора ответов сервера
+         *
+         * Большие ответы (например, за месяц) разбираются параллельно, результат не меняется.
+         * \param num_threads Количество потоков. Если 0, используется количество ядер процессора
+         */
+        void set_parse_threads(const uint32_t num_threads) {
+            parse_threads_ = num_threads;
         }
 //------------------------------------------------------------------------------
         /** \brief Загрузить все новости за дату
@@ -453,12 +1031,179 @@ public:
                 return NO_INIT;
             std::string request_body = get_request_body(beg_timestamp, end_timestamp);
             std::string response;
-            int err = do_post_request(request_body, response, sert_file_);
+            int err = get_response(request_body, end_timestamp, response);
             if(err == OK) {
                 err = parse_response(response, list_news);
             }
             return err;
         }
+//------------------------------------------------------------------------------
+        /** \brief Асинхронно загрузить все новости за дату
+         *
+         * Запрос выполняется в цикле curl_multi, которым владеет объект API.
+         * Один поток обслуживает сразу все запросы, поэтому одновременно может выполняться много запросов.
+         * Функция обратного вызова вызывается из потока цикла и не должна надолго его блокировать.
+         * Из нее можно удалить объект API: оставшиеся запросы будут завершены с кодом REQUEST_CANCELED.
+         * \param beg_timestamp начальная дата новостей
+         * \param end_timestamp конечная дата новостей
+         * \param callback функция обратного вызова, получит результат загрузки
+         * \return вернет 0, если запрос поставлен в очередь
+         */
+        int download_all_news_async(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                async_callback_t callback) {
+            if(is_curl_global_init_error_)
+                return NO_INIT;
+            int err = init_async_loop();
+            if(err != OK) return err;
+            AsyncRequest *request = new AsyncRequest();
+            request->request_body = get_request_body(beg_timestamp, end_timestamp);
+            request->end_timestamp = end_timestamp;
+            request->callback = callback;
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                /* объект удаляется, новые запросы уже некому выполнить */
+                if(is_async_stop_) {
+                    delete request;
+                    return REQUEST_CANCELED;
+                }
+                async_queue_.push_back(request);
+            }
+            wakeup_async_loop();
+            return OK;
+        }
+
+        /** \brief Асинхронно загрузить все новости за дату
+         * \param beg_timestamp начальная дата новостей
+         * \param end_timestamp конечная дата новостей
+         * \return std::future с результатом загрузки
+         */
+        std::future<AsyncResponse> download_all_news_async(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp) {
+            std::shared_ptr<std::promise<AsyncResponse>> promise = std::make_shared<std::promise<AsyncResponse>>();
+            std::future<AsyncResponse> future = promise->get_future();
+            int err = download_all_news_async(beg_timestamp, end_timestamp, [promise](AsyncResponse &response) {
+                promise->set_value(std::move(response));
+            });
+            if(err != OK) {
+                AsyncResponse response;
+                response.err = err;
+                promise->set_value(std::move(response));
+            }
+            return future;
+        }
+
+#       ifdef FOREXPROSTOOLS_API_USE_COROUTINE
+        /// Объект ожидания асинхронной загрузки для co_await
+        class AsyncAwaiter {
+        private:
+            ForexprostoolsApi *api_;
+            xtime::timestamp_t beg_timestamp_;
+            xtime::timestamp_t end_timestamp_;
+            AsyncResponse response_;
+        public:
+            AsyncAwaiter(ForexprostoolsApi *api, const xtime::timestamp_t beg_timestamp, const xtime::timestamp_t end_timestamp) :
+                api_(api), beg_timestamp_(beg_timestamp), end_timestamp_(end_timestamp) {};
+
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle) {
+                int err = api_->download_all_news_async(beg_timestamp_, end_timestamp_, [this, handle](AsyncResponse &response) {
+                    response_ = std::move(response);
+                    handle.resume();
+                });
+                if(err == OK) return true;
+                response_.err = err;
+                return false;
+            }
+
+            AsyncResponse await_resume() {
+                return std::move(response_);
+            }
+        };
+
+        /** \brief Загрузить все новости за дату внутри сопрограммы C++20
+         *
+         * Сопрограмма продолжит выполнение в потоке цикла асинхронных запросов
+         * и может в нем удалить объект API.
+         * \param beg_timestamp начальная дата новостей
+         * \param end_timestamp конечная дата новостей
+         * \return Объект для co_await
+         */
+        AsyncAwaiter co_download_all_news(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp) {
+            return AsyncAwaiter(this, beg_timestamp, end_timestamp);
+        }
+#       endif
+//------------------------------------------------------------------------------
+        /** \brief Запустить опрос новостей текущего дня
+         *
+         * Опрос выполняется в отдельном потоке с заданным периодом. Каждый ответ сравнивается
+         * с предыдущим по метке времени, имени и валюте новости, и функция обратного вызова
+         * вызывается только для новых или измененных новостей (например, когда вышло актуальное значение).
+         * После первого опроса и после смены дня все новости дня считаются новыми.
+         * Кэш ответов при опросе не используется. Если опрос уже запущен, он перезапускается.
+         * Из функций обратного вызова и планирования можно вызвать stop_watch() или удалить объект API,
+         * но нельзя перезапустить опрос: start_watch() из потока опроса вернет INIT_ERROR.
+         * \param interval_ms Период опроса в миллисекундах
+         * \param callback Функция обратного вызова, вызывается из потока опроса
+         * \return вернет 0 в случае успеха
+         */
+        int start_watch(const uint32_t interval_ms, watch_callback_t callback) {
+            return start_watch([interval_ms](WatchPlan &plan) {
+                plan.interval_ms = interval_ms;
+                plan.countries.clear();
+            }, callback);
+        }
+
+        /** \brief Запустить опрос новостей текущего дня по расписанию
+         *
+         * Перед каждым ожиданием вызывается функция планирования, которая задает задержку
+         * до следующего опроса и страны следующего запроса. Так можно, например, часто опрашивать
+         * только страны ближайшей важной новости и редко весь календарь (см. BurstScheduler).
+         * Из функций обратного вызова и планирования можно вызвать stop_watch() или удалить объект API,
+         * но нельзя перезапустить опрос: start_watch() из потока опроса вернет INIT_ERROR.
+         * \param schedule Функция планирования опроса, вызывается из потока опроса
+         * \param callback Функция обратного вызова, вызывается из потока опроса
+         * \return вернет 0 в случае успеха
+         */
+        int start_watch(watch_schedule_t schedule, watch_callback_t callback) {
+            if(is_curl_global_init_error_)
+                return NO_INIT;
+            if(schedule == nullptr || callback == nullptr) return INIT_ERROR;
+            if(std::this_thread::get_id() == watch_thread_.get_id()) return INIT_ERROR;
+            stop_watch();
+            std::lock_guard<std::mutex> lock(watch_mutex_);
+            is_watch_stop_ = false;
+            watch_thread_ = std::thread(&ForexprostoolsApi::watch_loop, this, schedule, callback, is_alive_);
+            is_watch_start_ = true;
+            return OK;
+        }
+
+        /** \brief Остановить опрос новостей текущего дня
+         *
+         * Если метод вызван из потока опроса (из функции обратного вызова или планирования),
+         * поток только получает флаг остановки и завершается после возврата из функции,
+         * а дождется его следующий вызов stop_watch(), start_watch() или деструктор.
+         */
+        void stop_watch() {
+            {
+                std::lock_guard<std::mutex> lock(watch_mutex_);
+                if(is_watch_start_) {
+                    is_watch_stop_ = true;
+                    is_watch_start_ = false;
+                }
+            }
+            watch_cv_.notify_one();
+            if(!watch_thread_.joinable()) return;
+            if(std::this_thread::get_id() == watch_thread_.get_id()) return;
+            watch_thread_.join();
+        }
 //------------------------------------------------------------------------------
         /** \brief Скачать и сохранить все доступыне данные по котировкам
          * \param path директория, куда сохраняются данные
@@ -545,6 +1290,9 @@ public:
          * \param timestamp_end_date Метка времени, на которой закончится загрузка данных (включительно указанный день)
          * \param is_use_day_off флаг пропуска выходных дней, true если надо пропускать выходные
          * \param user_function - функтор
+         * \param calendar Календарь дней без новостей. Известные пустые дни не запрашиваются,
+         * новые пустые дни передаются в calendar.set_empty_day. После пустого ответа следующие дни
+         * запрашиваются диапазоном (до calendar.max_range_days дней), и функтор получает новости по одному дню
          */
         int download_and_save_all_data(
                 const xtime::timestamp_t timestamp_start_date,
@@ -552,7 +1300,21 @@ public:
                 const bool is_use_day_off = true,
                 std::function<void(
                     const std::vector<ForexprostoolsApiEasy::News> &list_news,
-                    const xtime::timestamp_t timestamp)> user_function = NULL) {
+                    const xtime::timestamp_t timestamp)> user_function = NULL,
+                const SyncCalendar &calendar = SyncCalendar()) {
+            auto is_skip_day = [&](const xtime::timestamp_t t) -> bool {
+                if(!is_use_day_off && xtime::is_day_off(t)) return true;
+                return calendar.check_empty_day != nullptr && calendar.check_empty_day(t);
+            };
+            /* пустыми запоминаются только дни, в которые новые события уже не появятся */
+            const xtime::timestamp_t today = xtime::get_first_timestamp_day(xtime::get_timestamp());
+            const xtime::timestamp_t immutable_age = (xtime::timestamp_t)calendar.immutable_days * xtime::SECONDS_IN_DAY;
+            const xtime::timestamp_t immutable_time = today > immutable_age ? today - immutable_age : 0;
+            auto set_empty_day = [&](const xtime::timestamp_t t) {
+                if(calendar.set_empty_day != nullptr && t + xtime::SECONDS_IN_DAY <= immutable_time) calendar.set_empty_day(t);
+            };
+            const uint32_t max_range_days = std::max(calendar.max_range_days, (uint32_t)1);
+
             /* находим последнюю дату загрузки */
             xtime::timestamp_t stop_time = xtime::get_first_timestamp_day(timestamp_end_date);
             if(!is_use_day_off) {
@@ -563,30 +1325,68 @@ public:
             int err = OK;
             int num_download = 0;
             int num_errors = 0;
+            uint32_t range_days = 1;
+            std::vector<ForexprostoolsApiEasy::News> list_news; // список новостей
+            std::vector<ForexprostoolsApiEasy::News> day_news;  // новости одного дня из запроса за несколько дней
             while(stop_time >= timestamp_start_date) {
-                /* сначала выполняем проверку на вызодной */
-                if(!is_use_day_off && xtime::is_day_off(stop_time)) {
+                /* сначала выполняем проверку на вызодной и на день, про который известно, что новостей нет */
+                if(is_skip_day(stop_time)) {
                     if(stop_time == 0) break;
                     stop_time -= xtime::SECONDS_IN_DAY;
                     continue;
                 }
 
+                /* после пустых ответов несколько дней подряд запрашиваются одним запросом */
+                xtime::timestamp_t beg_time = stop_time;
+                uint32_t num_days = 1;
+                while(num_days < range_days &&
+                    beg_time >= xtime::SECONDS_IN_DAY &&
+                    beg_time - xtime::SECONDS_IN_DAY >= timestamp_start_date &&
+                    !is_skip_day(beg_time - xtime::SECONDS_IN_DAY)) {
+                    beg_time -= xtime::SECONDS_IN_DAY;
+                    ++num_days;
+                }
+
                 /* загружаем новости */
-                std::vector<ForexprostoolsApiEasy::News> list_news; // список новостей
-                err = download_all_news(stop_time, stop_time + xtime::SECONDS_IN_DAY - 1, list_news);
+                list_news.clear();
+                err = download_all_news(beg_time, stop_time + xtime::SECONDS_IN_DAY - 1, list_news);
                 if(err == OK && list_news.size() > 0) { // данные получены
-                    user_function(list_news, stop_time);
-                    ++num_download;
+                    if(num_days == 1) {
+                        user_function(list_news, stop_time);
+                        ++num_download;
+                    } else {
+                        /* раскладываем новости по дням, начиная с последнего дня, как при запросах по одному дню */
+                        for(xtime::timestamp_t t = stop_time; t >= beg_time; t -= xtime::SECONDS_IN_DAY) {
+                            day_news.clear();
+                            for(size_t i = 0; i < list_news.size(); ++i) {
+                                if(xtime::get_first_timestamp_day(list_news[i].timestamp) == t) day_news.push_back(list_news[i]);
+                            }
+                            if(day_news.size() > 0) {
+                                user_function(day_news, t);
+                                ++num_download;
+                            } else {
+                                set_empty_day(t);
+                            }
+                            if(t == beg_time) break;
+                        }
+                    }
                     num_errors = 0;
+                    range_days = 1;
                 } else {
-                    ++num_errors;
+                    if(err == OK) {
+                        for(xtime::timestamp_t t = beg_time; t <= stop_time; t += xtime::SECONDS_IN_DAY) {
+                            set_empty_day(t);
+                        }
+                        range_days = std::min(range_days * 2, max_range_days);
+                    }
+                    num_errors += num_days;
                 }
                 const int MAX_ERRORS = 30;
                 if(num_errors > MAX_ERRORS) {
                     break;
                 }
-                if(stop_time == 0) break;
-                stop_time -= xtime::SECONDS_IN_DAY;
+                if(beg_time == 0) break;
+                stop_time = beg_time - xtime::SECONDS_IN_DAY;
             }
             if(num_download == 0) {
                 if(err != OK) return err;
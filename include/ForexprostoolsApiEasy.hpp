@@ -32,6 +32,15 @@
 #include <string>
 #include <cctype>
 #include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
 
 namespace ForexprostoolsApiEasy {
 
@@ -42,6 +51,7 @@ namespace ForexprostoolsApiEasy {
         UNKNOWN_ERROR = -3,     ///< Неопределенная ошибка
         PARSER_ERROR = -4,      ///< Ошибка парсера
         INVALID_PARAMETER = -6, ///< Один из параметров неверно указан
+        WRITE_ERROR = -7,       ///< Ошибка записи
     };
 
     /// Уровни волатильности
@@ -77,6 +87,149 @@ namespace ForexprostoolsApiEasy {
         News() {};
     };
 
+    /** \brief Индекс времени событий
+     *
+     * Для каждого уровня силы и каждой валюты хранится отсортированный массив меток времени новостей,
+     * поэтому поиск ближайшего события выполняется двоичным поиском.
+     */
+    class EventIndex {
+    private:
+        std::unordered_map<std::string, std::vector<xtime::timestamp_t>> events_[HIGH + 1];
+
+        static bool check_level(const int level_volatility) {
+            return level_volatility >= LOW && level_volatility <= HIGH;
+        }
+
+    public:
+
+        EventIndex() {};
+
+        /** \brief Очистить индекс
+         */
+        void clear() {
+            for(int level = LOW; level <= HIGH; ++level) events_[level].clear();
+        }
+
+        /** \brief Добавить событие
+         *
+         * После добавления событий не по порядку нужно вызвать sort()
+         * \param currency Валюта новости
+         * \param level_volatility Уровень волатильности
+         * \param timestamp Метка времени новости
+         */
+        void add(const std::string &currency, const int level_volatility, const xtime::timestamp_t timestamp) {
+            if(!check_level(level_volatility)) return;
+            events_[level_volatility][currency].push_back(timestamp);
+        }
+
+        /** \brief Отсортировать метки времени событий
+         */
+        void sort() {
+            for(int level = LOW; level <= HIGH; ++level) {
+                for(auto it = events_[level].begin(); it != events_[level].end(); ++it) {
+                    if(!std::is_sorted(it->second.begin(), it->second.end())) {
+                        std::sort(it->second.begin(), it->second.end());
+                    }
+                }
+            }
+        }
+
+        /** \brief Удалить события за период
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (не включительно)
+         */
+        void remove(const xtime::timestamp_t beg_timestamp, const xtime::timestamp_t end_timestamp) {
+            for(int level = LOW; level <= HIGH; ++level) {
+                for(auto it = events_[level].begin(); it != events_[level].end(); ++it) {
+                    std::vector<xtime::timestamp_t> &list = it->second;
+                    list.erase(
+                        std::lower_bound(list.begin(), list.end(), beg_timestamp),
+                        std::lower_bound(list.begin(), list.end(), end_timestamp));
+                }
+            }
+        }
+
+        /** \brief Найти следующее событие
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param event_timestamp Метка времени первого события строго после timestamp
+         * \return Вернет true, если событие найдено
+         */
+        bool find_next(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                xtime::timestamp_t &event_timestamp) const {
+            bool is_found = false;
+            auto check = [&](const std::vector<xtime::timestamp_t> &list) {
+                auto it = std::upper_bound(list.begin(), list.end(), timestamp);
+                if(it == list.end()) return;
+                if(!is_found || *it < event_timestamp) event_timestamp = *it;
+                is_found = true;
+            };
+            for(int level = std::max(min_level_volatility, (int)LOW); level <= HIGH; ++level) {
+                if(currencies.empty()) {
+                    for(auto it = events_[level].begin(); it != events_[level].end(); ++it) check(it->second);
+                    continue;
+                }
+                for(size_t i = 0; i < currencies.size(); ++i) {
+                    auto it = events_[level].find(currencies[i]);
+                    if(it != events_[level].end()) check(it->second);
+                }
+            }
+            return is_found;
+        }
+
+        /** \brief Найти предыдущее событие
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param event_timestamp Метка времени последнего события не позже timestamp
+         * \return Вернет true, если событие найдено
+         */
+        bool find_prev(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                xtime::timestamp_t &event_timestamp) const {
+            bool is_found = false;
+            auto check = [&](const std::vector<xtime::timestamp_t> &list) {
+                auto it = std::upper_bound(list.begin(), list.end(), timestamp);
+                if(it == list.begin()) return;
+                --it;
+                if(!is_found || *it > event_timestamp) event_timestamp = *it;
+                is_found = true;
+            };
+            for(int level = std::max(min_level_volatility, (int)LOW); level <= HIGH; ++level) {
+                if(currencies.empty()) {
+                    for(auto it = events_[level].begin(); it != events_[level].end(); ++it) check(it->second);
+                    continue;
+                }
+                for(size_t i = 0; i < currencies.size(); ++i) {
+                    auto it = events_[level].find(currencies[i]);
+                    if(it != events_[level].end()) check(it->second);
+                }
+            }
+            return is_found;
+        }
+    };
+
+    /** \brief Проверить, подходит ли новость под условие поиска события
+     * \param news Новость
+     * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+     * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+     * \return Вернет true, если новость подходит
+     */
+    inline bool check_event(
+            const News &news,
+            const std::vector<std::string> &currencies,
+            const int min_level_volatility) {
+        if(news.level_volatility < std::max(min_level_volatility, (int)LOW) || news.level_volatility > HIGH) return false;
+        if(currencies.empty()) return true;
+        return std::find(currencies.begin(), currencies.end(), news.currency) != currencies.end();
+    }
+
     /** \brief Список новостей
      *
      * Данный класс хранит в себе массив новостей и позволяет получать к нему удобный доступ черех методы класса
@@ -84,6 +237,40 @@ namespace ForexprostoolsApiEasy {
     class NewsList {
     private:
         std::vector<News> list_news_;
+        EventIndex event_index_;        /**< Индекс событий, строится при первом поиске события */
+        bool is_event_index_ = false;   /**< Флаг готовности индекса событий */
+
+        /** \brief Найти новость события по метке времени
+         * \param event_timestamp Метка времени события
+         * \param currencies Валюты новостей
+         * \param min_level_volatility Минимальный уровень силы новости
+         * \param news Новость
+         * \return Вернет 0 в случае успеха
+         */
+        int get_event(
+                const xtime::timestamp_t event_timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) const {
+            auto it = std::lower_bound(list_news_.begin(), list_news_.end(), event_timestamp, [](const News &lhs, xtime::timestamp_t rhs) {
+                return lhs.timestamp < rhs;
+            });
+            for(; it != list_news_.end() && it->timestamp == event_timestamp; ++it) {
+                if(!check_event(*it, currencies, min_level_volatility)) continue;
+                news = *it;
+                return OK;
+            }
+            return NO_DATA_ACCESS;
+        }
+
+        void init_event_index() {
+            if(is_event_index_) return;
+            event_index_.clear();
+            for(size_t i = 0; i < list_news_.size(); ++i) {
+                event_index_.add(list_news_[i].currency, list_news_[i].level_volatility, list_news_[i].timestamp);
+            }
+            is_event_index_ = true;
+        }
     public:
         NewsList() {};
 
@@ -91,10 +278,22 @@ namespace ForexprostoolsApiEasy {
          * \param list_news список новостей
          */
         void add_news(const std::vector<News> &list_news) {
-            list_news_.insert(list_news_.end(), list_news.begin(), list_news.end());
-            std::sort(list_news_.begin(), list_news_.end(), [](const News &lhs, const News &rhs) {
+            if(list_news.size() == 0) return;
+            is_event_index_ = false;
+            auto compare = [](const News &lhs, const News &rhs) {
                 return lhs.timestamp < rhs.timestamp;
-            });
+            };
+            const size_t middle = list_news_.size();
+            list_news_.insert(list_news_.end(), list_news.begin(), list_news.end());
+            /* новости обычно добавляются по дням в порядке возрастания,
+             * поэтому сортируем только добавленную часть и сливаем ее с уже отсортированной
+             */
+            if(!std::is_sorted(list_news_.begin() + middle, list_news_.end(), compare)) {
+                std::stable_sort(list_news_.begin() + middle, list_news_.end(), compare);
+            }
+            if(middle > 0 && compare(list_news_[middle], list_news_[middle - 1])) {
+                std::inplace_merge(list_news_.begin(), list_news_.begin() + middle, list_news_.end(), compare);
+            }
         }
 
         /** \brief Инициализировать список новостей
@@ -136,8 +335,8 @@ namespace ForexprostoolsApiEasy {
             if(lower == list_news_.end() && upper == list_news_.begin()) {
                 return NO_DATA_ACCESS;//*
             }
-            list_news.clear();
-            list_news.insert(list_news.begin(), lower, upper);
+            /* assign копирует поверх существующих элементов и не освобождает память их строк */
+            list_news.assign(lower, upper);
             return OK;
         }
 
@@ -169,6 +368,224 @@ namespace ForexprostoolsApiEasy {
          */
         void clear() {
             list_news_.clear();
+            event_index_.clear();
+            is_event_index_ = false;
+        }
+
+        /** \brief Найти следующее событие
+         *
+         * Индекс событий строится при первом вызове, поиск выполняется двоичным поиском.
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param news Первая подходящая новость строго после timestamp
+         * \return Вернет 0 в случае успеха
+         */
+        int next_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            init_event_index();
+            xtime::timestamp_t event_timestamp = 0;
+            if(!event_index_.find_next(timestamp, currencies, min_level_volatility, event_timestamp)) return NO_DATA_ACCESS;
+            return get_event(event_timestamp, currencies, min_level_volatility, news);
+        }
+
+        /** \brief Найти предыдущее событие
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param news Последняя подходящая новость не позже timestamp
+         * \return Вернет 0 в случае успеха
+         */
+        int prev_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            init_event_index();
+            xtime::timestamp_t event_timestamp = 0;
+            if(!event_index_.find_prev(timestamp, currencies, min_level_volatility, event_timestamp)) return NO_DATA_ACCESS;
+            return get_event(event_timestamp, currencies, min_level_volatility, news);
+        }
+    };
+
+    /** \brief Код валюты
+     *
+     * Три буквы валюты упакованы в одно число, поэтому сравнение валют не требует работы со строками.
+     */
+    class CurrencyCode {
+    private:
+        uint32_t code_ = 0;
+
+    public:
+
+        CurrencyCode() {};
+
+        /** \brief Инициализировать код валюты
+         * \param currency Имя валюты из трех букв
+         */
+        explicit CurrencyCode(const std::string &currency) : code_(pack(currency)) {};
+
+        /** \brief Инициализировать код валюты
+         * \param code Упакованный код валюты
+         */
+        explicit CurrencyCode(const uint32_t code) : code_(code) {};
+
+        /** \brief Упаковать имя валюты
+         * \param currency Имя валюты
+         * \return Код валюты или 0, если имя не состоит из трех символов
+         */
+        inline static uint32_t pack(const std::string &currency) {
+            if(currency.size() != 3) return 0;
+            return pack(currency[0], currency[1], currency[2]);
+        }
+
+        /** \brief Упаковать три символа имени валюты
+         * \return Код валюты
+         */
+        inline static uint32_t pack(const char c0, const char c1, const char c2) {
+            return (uint32_t)(uint8_t)c0 | ((uint32_t)(uint8_t)c1 << 8) | ((uint32_t)(uint8_t)c2 << 16);
+        }
+
+        /** \brief Получить упакованный код валюты
+         * \return Код валюты
+         */
+        inline uint32_t get_code() const {
+            return code_;
+        }
+
+        /** \brief Проверить код валюты
+         * \return Вернет true, если код валюты задан
+         */
+        inline bool is_valid() const {
+            return code_ != 0;
+        }
+
+        /** \brief Сравнить с именем валюты
+         * \param currency Имя валюты
+         * \return Вернет true, если имя соответствует коду
+         */
+        inline bool is_equal(const std::string &currency) const {
+            return code_ != 0 && pack(currency) == code_;
+        }
+
+        /** \brief Получить имя валюты
+         * \return Имя валюты
+         */
+        std::string to_str() const {
+            if(code_ == 0) return std::string();
+            const char str[3] = {(char)(code_ & 0xFF), (char)((code_ >> 8) & 0xFF), (char)((code_ >> 16) & 0xFF)};
+            return std::string(str, 3);
+        }
+
+        inline bool operator == (const CurrencyCode &other) const {
+            return code_ == other.code_;
+        }
+
+        inline bool operator != (const CurrencyCode &other) const {
+            return code_ != other.code_;
+        }
+    };
+
+    /** \brief Валютная пара
+     *
+     * Имя валютной пары разбирается один раз, после чего проверка валюты новости
+     * сводится к сравнению двух чисел.
+     */
+    class CurrencyPair {
+    private:
+        CurrencyCode base_;     /**< Первая валюта валютной пары */
+        CurrencyCode quote_;    /**< Вторая валюта валютной пары */
+
+    public:
+
+        CurrencyPair() {};
+
+        /** \brief Инициализировать валютную пару
+         *
+         * Если имя пары неверно, is_valid() вернет false
+         * \param pair_name Имя валютной пары
+         */
+        CurrencyPair(const std::string &pair_name) {
+            parse(pair_name);
+        }
+
+        /** \brief Разобрать имя валютной пары
+         *
+         * Разбор совпадает с get_currencies: удаляются все символы, кроме букв, и приставка frx,
+         * после чего должно остаться шесть букв. Разбор выполняется без выделения памяти.
+         * \param pair_name Имя валютной пары
+         * \return Вернет 0 в случае успеха
+         */
+        int parse(const std::string &pair_name) {
+            const size_t NAME_LEN = 6;
+            const size_t MAX_LEN = 64;
+            base_ = quote_ = CurrencyCode();
+            if(pair_name.size() < NAME_LEN) return INVALID_PARAMETER;
+            char name[MAX_LEN];
+            size_t len = 0;
+            for(size_t i = 0; i < pair_name.size(); ++i) {
+                if(!std::isalpha((unsigned char)pair_name[i])) continue;
+                if(len == MAX_LEN) return INVALID_PARAMETER;
+                name[len++] = pair_name[i];
+            }
+            /* приставка ищется так же, как раньше: после удаления поиск продолжается с позиции pos + 1 */
+            size_t start = 0;
+            while(true) {
+                size_t pos = start;
+                while(pos + 3 <= len && !(name[pos] == 'f' && name[pos + 1] == 'r' && name[pos + 2] == 'x')) ++pos;
+                if(pos + 3 > len) break;
+                std::memmove(name + pos, name + pos + 3, len - pos - 3);
+                len -= 3;
+                start = pos + 1;
+            }
+            if(len != NAME_LEN) return INVALID_PARAMETER;
+            for(size_t i = 0; i < NAME_LEN; ++i) {
+                name[i] = (char)std::toupper((unsigned char)name[i]);
+            }
+            base_ = CurrencyCode(CurrencyCode::pack(name[0], name[1], name[2]));
+            quote_ = CurrencyCode(CurrencyCode::pack(name[3], name[4], name[5]));
+            return OK;
+        }
+
+        /** \brief Получить первую валюту пары
+         * \return Код валюты
+         */
+        inline const CurrencyCode &get_base() const {
+            return base_;
+        }
+
+        /** \brief Получить вторую валюту пары
+         * \return Код валюты
+         */
+        inline const CurrencyCode &get_quote() const {
+            return quote_;
+        }
+
+        /** \brief Проверить валютную пару
+         * \return Вернет true, если пара разобрана
+         */
+        inline bool is_valid() const {
+            return base_.is_valid() && quote_.is_valid();
+        }
+
+        /** \brief Проверить содержание валюты в валютной паре
+         * \param currency Имя валюты
+         * \return Вернет true, если валютная пара содержит указанную валюту
+         */
+        inline bool check(const std::string &currency) const {
+            const uint32_t code = CurrencyCode::pack(currency);
+            return code != 0 && (code == base_.get_code() || code == quote_.get_code());
+        }
+
+        /** \brief Проверить содержание кода валюты в валютной паре
+         * \param currency Код валюты
+         * \return Вернет true, если валютная пара содержит указанную валюту
+         */
+        inline bool check(const CurrencyCode &currency) const {
+            return currency.is_valid() && (currency == base_ || currency == quote_);
         }
     };
 
@@ -178,25 +595,15 @@ namespace ForexprostoolsApiEasy {
      * \param currency_2 вторая валюта валютной пары
      * \return вернет 0 в случае успеха
      */
-    int get_currencies(
-            std::string pair_name,
+    inline int get_currencies(
+            const std::string &pair_name,
             std::string &currency_1,
             std::string &currency_2) {
-        const size_t NAME_LEN = 6;
-        if(pair_name.size() < NAME_LEN) return INVALID_PARAMETER;
-        pair_name.erase(std::remove_if(pair_name.begin(), pair_name.end(), [](int c) {
-            return !std::isalpha(c);
-        }), pair_name.end());
-        const std::string str_del = "frx";
-        std::string::size_type pos = pair_name.find(str_del);
-        while(pos != std::string::npos) {
-            pair_name.erase(pos, str_del.size());
-            pos = pair_name.find(str_del, pos + 1);
-        }
-        std::transform(pair_name.begin(), pair_name.end(),pair_name.begin(), ::toupper);
-        if(pair_name.size() != NAME_LEN) return INVALID_PARAMETER;
-        currency_1 = pair_name.substr(0, 3);
-        currency_2 = pair_name.substr(3, 3);
+        CurrencyPair pair;
+        int err = pair.parse(pair_name);
+        if(err != OK) return err;
+        currency_1 = pair.get_base().to_str();
+        currency_2 = pair.get_quote().to_str();
         return OK;
     }
 
@@ -205,14 +612,10 @@ namespace ForexprostoolsApiEasy {
      * \param currency Валюта
      * \return Вернет true, если валютная пара содержит указанную валюту
      */
-    bool is_currency(std::string pair_name, std::string currency) {
-        int err = ForexprostoolsApiEasy::OK;
-        std::string currency_1;
-        std::string currency_2;
-        if((err = get_currencies(pair_name, currency_1, currency_2)) !=
-            ForexprostoolsApiEasy::OK) return false;
-        if(currency_1 == currency || currency_2 == currency) return true;
-        return false;
+    inline bool is_currency(const std::string &pair_name, const std::string &currency) {
+        CurrencyPair pair;
+        if(pair.parse(pair_name) != OK) return false;
+        return pair.check(currency);
     }
 
     /** \brief Проверить содержание имени валюты в начале имени валютной пары
@@ -220,14 +623,10 @@ namespace ForexprostoolsApiEasy {
      * \param currency Валюта
      * \return Вернет true, если валютная пара находится в начале имени валютной пары
      */
-    bool is_first_currency(std::string pair_name, std::string currency) {
-        int err = ForexprostoolsApiEasy::OK;
-        std::string currency_1;
-        std::string currency_2;
-        if((err = get_currencies(pair_name, currency_1, currency_2)) !=
-            ForexprostoolsApiEasy::OK) return false;
-        if(currency_1 == currency) return true;
-        return false;
+    inline bool is_first_currency(const std::string &pair_name, const std::string &currency) {
+        CurrencyPair pair;
+        if(pair.parse(pair_name) != OK) return false;
+        return pair.get_base().is_equal(currency);
     }
 
     enum class CurrencyPairNameAnalysisResults {
@@ -252,6 +651,105 @@ namespace ForexprostoolsApiEasy {
         if(currency_2 == currency) return CurrencyPairNameAnalysisResults::CURRENCY_DENOMINATOR;
         return CurrencyPairNameAnalysisResults::CURRENCY_NOT_FOUND;
     }
+
+    /** \brief Получить хеш массива байтов (FNV-1a, 64 бита)
+     * \param data Указатель на данные
+     * \param size Размер данных
+     * \return Хеш данных
+     */
+    inline uint64_t get_hash(const char *data, const size_t size) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for(size_t i = 0; i < size; ++i) {
+            hash ^= (uint8_t)data[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /** \brief Получить хеш строки (FNV-1a, 64 бита)
+     * \param str Строка
+     * \return Хеш строки
+     */
+    inline uint64_t get_hash(const std::string &str) {
+        return get_hash(str.data(), str.size());
+    }
+
+    /** \brief Заменить файл другим файлом
+     *
+     * В POSIX rename заменяет файл атомарно, уже открытый файл остается доступен тем, кто его открыл.
+     * В Windows используется MoveFileExA с заменой существующего файла,
+     * при этом файл, открытый или отображенный в память другим процессом, заменить нельзя.
+     * \param src_file_name Имя нового файла
+     * \param dst_file_name Имя заменяемого файла
+     * \return Вернет true в случае успеха
+     */
+    inline bool replace_file(const std::string &src_file_name, const std::string &dst_file_name) {
+#       if defined(_WIN32)
+        return MoveFileExA(src_file_name.c_str(), dst_file_name.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#       else
+        return std::rename(src_file_name.c_str(), dst_file_name.c_str()) == 0;
+#       endif
+    }
+
+    /** \brief Проверить равенство всех полей новостей
+     * \param lhs Первая новость
+     * \param rhs Вторая новость
+     * \return Вернет true, если новости совпадают
+     */
+    inline bool is_equal_news(const News &lhs, const News &rhs) {
+        return lhs.timestamp == rhs.timestamp &&
+            lhs.level_volatility == rhs.level_volatility &&
+            lhs.is_previous == rhs.is_previous &&
+            lhs.is_actual == rhs.is_actual &&
+            lhs.is_forecast == rhs.is_forecast &&
+            (!lhs.is_previous || lhs.previous == rhs.previous) &&
+            (!lhs.is_actual || lhs.actual == rhs.actual) &&
+            (!lhs.is_forecast || lhs.forecast == rhs.forecast) &&
+            lhs.name == rhs.name &&
+            lhs.currency == rhs.currency &&
+            lhs.country == rhs.country;
+    }
+
+    /** \brief Сравнить два списка новостей
+     *
+     * Новости сопоставляются по метке времени, имени и валюте.
+     * \param old_list_news Старый список новостей
+     * \param new_list_news Новый список новостей
+     * \param changed_news Новости, которые появились или изменились в новом списке
+     * \param removed_news Новости, которых больше нет в новом списке
+     */
+    inline void compare_news(
+            const std::vector<News> &old_list_news,
+            const std::vector<News> &new_list_news,
+            std::vector<News> &changed_news,
+            std::vector<News> &removed_news) {
+        auto compare_key = [](const News *lhs, const News *rhs) {
+            if(lhs->timestamp != rhs->timestamp) return lhs->timestamp < rhs->timestamp;
+            int cmp = lhs->currency.compare(rhs->currency);
+            if(cmp != 0) return cmp < 0;
+            return lhs->name < rhs->name;
+        };
+        std::vector<const News*> old_keys(old_list_news.size()), new_keys(new_list_news.size());
+        for(size_t i = 0; i < old_list_news.size(); ++i) old_keys[i] = &old_list_news[i];
+        for(size_t i = 0; i < new_list_news.size(); ++i) new_keys[i] = &new_list_news[i];
+        std::sort(old_keys.begin(), old_keys.end(), compare_key);
+        std::sort(new_keys.begin(), new_keys.end(), compare_key);
+        changed_news.clear();
+        removed_news.clear();
+        size_t i = 0, n = 0;
+        while(i < old_keys.size() || n < new_keys.size()) {
+            if(n >= new_keys.size() || (i < old_keys.size() && compare_key(old_keys[i], new_keys[n]))) {
+                removed_news.push_back(*old_keys[i++]);
+            } else
+            if(i >= old_keys.size() || compare_key(new_keys[n], old_keys[i])) {
+                changed_news.push_back(*new_keys[n++]);
+            } else {
+                if(!is_equal_news(*old_keys[i], *new_keys[n])) changed_news.push_back(*new_keys[n]);
+                ++i;
+                ++n;
+            }
+        }
+    }
 //------------------------------------------------------------------------------
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 // !!!!!!!!!!!!ДАЛЬШЕ УСТАРЕВШИЙ КОД! НЕ РЕКОМЕНДУЕТСЯ ИСПОЛЬЗОВАТЬ!!!!!!!!!!!!!
@@ -273,6 +771,28 @@ namespace ForexprostoolsApiEasy {
                         std::to_string(iTime.day);
                 return file_name;
         }
+//------------------------------------------------------------------------------
+        /** \brief Получить дату из имени файла
+         * Обратная функция для get_file_name_from_date, имя файла может содержать путь и расширение
+         * \param file_name имя файла вида ГОД_МЕСЯЦ_ДЕНЬ.json
+         * \param timestamp временная метка начала дня
+         * \return вернет true в случае успеха
+         */
+        inline bool get_date_from_file_name(const std::string &file_name, xtime::timestamp_t &timestamp)
+        {
+                std::size_t name_pos = file_name.find_last_of("/\\");
+                name_pos = name_pos == std::string::npos ? 0 : name_pos + 1;
+                int year = 0, month = 0, day = 0;
+                char tail = 0;
+                if(std::sscanf(file_name.c_str() + name_pos, "%d_%d_%d%c", &year, &month, &day, &tail) < 3)
+                        return false;
+                if(tail != 0 && tail != '.')
+                        return false;
+                if(year < 1970 || month < 1 || month > 12 || day < 1 || day > 31)
+                        return false;
+                timestamp = xtime::get_timestamp(day, month, year);
+                return true;
+        }
 //------------------------------------------------------------------------------
         /** \brief Записать файл новостей
          * \param file_name имя файла
@@ -319,9 +839,18 @@ namespace ForexprostoolsApiEasy {
                                 auto it_actual = j[i].find("actual");
                                 auto it_forecast = j[i].find("forecast");
 
-                                if(it_previous != j[i].end()) list_news[i].previous = *it_previous;
-                                if(it_actual != j[i].end()) list_news[i].actual = *it_actual;
-                                if(it_forecast != j[i].end()) list_news[i].forecast = *it_forecast;
+                                if(it_previous != j[i].end()) {
+                                        list_news[i].previous = *it_previous;
+                                        list_news[i].is_previous = true;
+                                }
+                                if(it_actual != j[i].end()) {
+                                        list_news[i].actual = *it_actual;
+                                        list_news[i].is_actual = true;
+                                }
+                                if(it_forecast != j[i].end()) {
+                                        list_news[i].forecast = *it_forecast;
+                                        list_news[i].is_forecast = true;
+                                }
                         }
                 }
                 catch(...) {
@@ -0,0 +1,175 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_BURST_SCHEDULER_HPP_INCLUDED
+#define FOREXPROSTOOLS_BURST_SCHEDULER_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApi.hpp>
+#include <ForexprostoolsDataStore.hpp>
+#include <chrono>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsDataStore {
+
+    /** \brief Параметры опроса вокруг выхода новостей
+     */
+    class BurstConfig {
+    public:
+        std::vector<std::string> currencies;        /**< Валюты новостей. Если список пуст, подходят все валюты */
+        int min_level_volatility = HIGH;            /**< Минимальный уровень силы новости */
+        uint32_t warmup_ms = 5000;                  /**< За сколько до начала окна выполнить запрос для прогрева соединения */
+        uint32_t burst_before_ms = 2000;            /**< Начало окна частого опроса до выхода новости */
+        uint32_t burst_after_ms = 60000;            /**< Конец окна частого опроса после выхода новости */
+        uint32_t burst_interval_ms = 250;           /**< Период опроса внутри окна */
+        uint32_t slow_interval_ms = 60000;          /**< Период опроса всего календаря вне окон */
+
+        BurstConfig() {};
+    };
+
+    /** \brief Планировщик опроса вокруг выхода новостей
+     *
+     * Время ближайшей подходящей новости берется из хранилища (DataStore::next_event).
+     * Вне окон весь календарь дня опрашивается редко. За warmup_ms до окна выполняется
+     * запрос, который заранее устанавливает соединение (DNS, TCP, TLS), а внутри окна
+     * часто опрашиваются только страны новостей, окна которых содержат текущее время.
+     * Хранилище используется из потока опроса, поэтому пока опрос запущен,
+     * другие потоки не должны обращаться к этому же объекту DataStore.
+     */
+    class BurstScheduler {
+    private:
+        DataStore &store_;
+        BurstConfig config_;
+        std::vector<News> buffer_news_;
+
+        /** \brief Получить страны новостей, выходящих в момент события
+         * \param timestamp Метка времени события
+         * \param countries Коды стран. Если страну одной из новостей определить нельзя, список будет пуст
+         */
+        void get_countries(const xtime::timestamp_t timestamp, std::vector<int> &countries) {
+            countries.clear();
+            if(store_.get(timestamp, 0, 0, buffer_news_) != OK) return;
+            for(size_t i = 0; i < buffer_news_.size(); ++i) {
+                const News &news = buffer_news_[i];
+                if(news.timestamp != timestamp || news.level_volatility < config_.min_level_volatility) continue;
+                if(!config_.currencies.empty() &&
+                    std::find(config_.currencies.begin(), config_.currencies.end(), news.currency) == config_.currencies.end()) continue;
+                const int code = ForexprostoolsApi::get_country_code(news.country);
+                if(code == 0) {
+                    countries.clear();
+                    return;
+                }
+                if(std::find(countries.begin(), countries.end(), code) == countries.end()) countries.push_back(code);
+            }
+        }
+
+        /** \brief Получить страны новостей, окна частого опроса которых содержат момент времени
+         *
+         * Окна нескольких новостей могут пересекаться, поэтому берется объединение стран всех таких новостей.
+         * \param time_ms Момент времени в миллисекундах
+         * \param countries Коды стран. Если страну одной из новостей определить нельзя, список будет пуст
+         */
+        void get_burst_countries(const uint64_t time_ms, std::vector<int> &countries) {
+            countries.clear();
+            std::vector<int> event_countries;
+            xtime::timestamp_t timestamp = time_ms > config_.burst_after_ms ? (time_ms - config_.burst_after_ms) / 1000 : 0;
+            News news;
+            while(store_.next_event(timestamp, config_.currencies, config_.min_level_volatility, news) == OK) {
+                timestamp = news.timestamp;
+                const uint64_t event_ms = (uint64_t)news.timestamp * 1000;
+                /* окно этой и следующих новостей еще не началось */
+                if(event_ms > time_ms + config_.burst_before_ms) break;
+                if(event_ms + config_.burst_after_ms <= time_ms) continue;
+                get_countries(news.timestamp, event_countries);
+                if(event_countries.empty()) {
+                    countries.clear();
+                    return;
+                }
+                for(size_t i = 0; i < event_countries.size(); ++i) {
+                    if(std::find(countries.begin(), countries.end(), event_countries[i]) == countries.end()) {
+                        countries.push_back(event_countries[i]);
+                    }
+                }
+            }
+        }
+
+    public:
+
+        /** \brief Планировщик опроса
+         * \param store Хранилище с расписанием новостей
+         * \param config Параметры опроса
+         */
+        BurstScheduler(DataStore &store, const BurstConfig &config = BurstConfig()) :
+            store_(store), config_(config) {};
+
+        /** \brief Получить текущее время в миллисекундах
+         * \return Метка времени в миллисекундах
+         */
+        static uint64_t get_time_ms() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        /** \brief Спланировать следующий опрос
+         * \param now_ms Текущее время в миллисекундах
+         * \param plan План следующего опроса
+         */
+        void get_plan(const uint64_t now_ms, ForexprostoolsApi::WatchPlan &plan) {
+            plan.interval_ms = std::max(config_.slow_interval_ms, (uint32_t)1);
+            plan.countries.clear();
+
+            /* ближайшая новость, окно которой еще не закончилось */
+            const xtime::timestamp_t now = now_ms / 1000;
+            const xtime::timestamp_t after = config_.burst_after_ms / 1000;
+            News news;
+            if(store_.next_event(now > after ? now - after : 0, config_.currencies, config_.min_level_volatility, news) != OK) return;
+            const uint64_t event_ms = (uint64_t)news.timestamp * 1000;
+            const uint64_t burst_beg_ms = event_ms - std::min(event_ms, (uint64_t)config_.burst_before_ms);
+            const uint64_t burst_end_ms = event_ms + config_.burst_after_ms;
+            const uint64_t warmup_ms = burst_beg_ms - std::min(burst_beg_ms, (uint64_t)config_.warmup_ms);
+            if(now_ms >= burst_end_ms) return;
+
+            if(now_ms >= burst_beg_ms) {
+                plan.interval_ms = std::max(config_.burst_interval_ms, (uint32_t)1);
+                get_burst_countries(now_ms, plan.countries);
+                return;
+            }
+            /* до окна просыпаемся к прогреву соединения и к началу окна */
+            uint64_t wake_ms = now_ms + plan.interval_ms;
+            if(warmup_ms > now_ms) wake_ms = std::min(wake_ms, warmup_ms);
+            wake_ms = std::min(wake_ms, burst_beg_ms);
+            plan.interval_ms = (uint32_t)std::max(wake_ms - now_ms, (uint64_t)1);
+            if(wake_ms >= warmup_ms) get_burst_countries(burst_beg_ms, plan.countries);
+        }
+
+        /** \brief Запустить опрос по расписанию
+         * \param api Объект API
+         * \param callback Функция обратного вызова, получит новые и измененные новости
+         * \return вернет 0 в случае успеха
+         */
+        int start(ForexprostoolsApi &api, ForexprostoolsApi::watch_callback_t callback) {
+            return api.start_watch([this](ForexprostoolsApi::WatchPlan &plan) {
+                get_plan(get_time_ms(), plan);
+            }, callback);
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_BURST_SCHEDULER_HPP_INCLUDED
@@ -0,0 +1,187 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_BYTE_SCAN_HPP_INCLUDED
+#define FOREXPROSTOOLS_BYTE_SCAN_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#ifndef FOREXPROSTOOLS_USE_AVX2
+#define FOREXPROSTOOLS_USE_AVX2
+#endif
+#include <immintrin.h>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /** \brief Найти последовательность байтов (скалярная версия)
+     *
+     * Кандидаты ищутся по первому байту через memchr, затем проверяются через memcmp.
+     * \param data Данные
+     * \param size Размер данных
+     * \param needle Искомая последовательность, не меньше одного байта
+     * \param needle_size Размер искомой последовательности
+     * \return Позиция последовательности или size, если она не найдена
+     */
+    inline size_t find_bytes_scalar(
+            const char *data,
+            const size_t size,
+            const char *needle,
+            const size_t needle_size) {
+        if(needle_size > size) return size;
+        const size_t last = size - needle_size;
+        size_t i = 0;
+        while(i <= last) {
+            const void *candidate = std::memchr(data + i, needle[0], last - i + 1);
+            if(candidate == NULL) return size;
+            i = (const char*)candidate - data;
+            if(std::memcmp(data + i + 1, needle + 1, needle_size - 1) == 0) return i;
+            ++i;
+        }
+        return size;
+    }
+
+#   if defined(FOREXPROSTOOLS_USE_AVX2)
+    /** \brief Найти последовательность байтов (SSE2)
+     *
+     * За одну итерацию проверяются 16 позиций: кандидатом считается позиция,
+     * где совпали первый и последний байты последовательности.
+     * \param data Данные
+     * \param size Размер данных
+     * \param needle Искомая последовательность, не меньше двух байтов
+     * \param needle_size Размер искомой последовательности
+     * \return Позиция последовательности или size, если она не найдена
+     */
+    __attribute__((target("sse2")))
+    inline size_t find_bytes_sse2(
+            const char *data,
+            const size_t size,
+            const char *needle,
+            const size_t needle_size) {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needle_size - 1]);
+        size_t i = 0;
+        for(; i + 16 + needle_size - 1 <= size; i += 16) {
+            const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + needle_size - 1));
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first, block_first),
+                _mm_cmpeq_epi8(last, block_last)));
+            while(mask != 0) {
+                const size_t pos = i + __builtin_ctz(mask);
+                if(std::memcmp(data + pos + 1, needle + 1, needle_size - 2) == 0) return pos;
+                mask &= mask - 1;
+            }
+        }
+        const size_t pos = find_bytes_scalar(data + i, size - i, needle, needle_size);
+        return pos == size - i ? size : i + pos;
+    }
+
+    /** \brief Найти последовательность байтов (AVX2)
+     *
+     * За одну итерацию проверяются 32 позиции.
+     * \param data Данные
+     * \param size Размер данных
+     * \param needle Искомая последовательность, не меньше двух байтов
+     * \param needle_size Размер искомой последовательности
+     * \return Позиция последовательности или size, если она не найдена
+     */
+    __attribute__((target("avx2")))
+    inline size_t find_bytes_avx2(
+            const char *data,
+            const size_t size,
+            const char *needle,
+            const size_t needle_size) {
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needle_size - 1]);
+        size_t i = 0;
+        for(; i + 32 + needle_size - 1 <= size; i += 32) {
+            const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + needle_size - 1));
+            uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+                _mm256_cmpeq_epi8(first, block_first),
+                _mm256_cmpeq_epi8(last, block_last)));
+            while(mask != 0) {
+                const size_t pos = i + __builtin_ctz(mask);
+                if(std::memcmp(data + pos + 1, needle + 1, needle_size - 2) == 0) return pos;
+                mask &= mask - 1;
+            }
+        }
+        const size_t pos = find_bytes_scalar(data + i, size - i, needle, needle_size);
+        return pos == size - i ? size : i + pos;
+    }
+#   endif
+
+    /** \brief Найти последовательность байтов
+     *
+     * Если процессор поддерживает AVX2, используется версия AVX2, иначе SSE2 или скалярная версия.
+     * Один байт ищется через memchr.
+     * \param data Данные
+     * \param size Размер данных
+     * \param needle Искомая последовательность
+     * \param needle_size Размер искомой последовательности
+     * \return Позиция последовательности или size, если она не найдена
+     */
+    inline size_t find_bytes(
+            const char *data,
+            const size_t size,
+            const char *needle,
+            const size_t needle_size) {
+        if(needle_size == 0) return 0;
+        if(needle_size > size) return size;
+        if(needle_size == 1) {
+            const void *pos = std::memchr(data, needle[0], size);
+            return pos == NULL ? size : (size_t)((const char*)pos - data);
+        }
+#       if defined(FOREXPROSTOOLS_USE_AVX2)
+        static const bool is_avx2 = __builtin_cpu_supports("avx2");
+        static const bool is_sse2 = __builtin_cpu_supports("sse2");
+        if(is_avx2) return find_bytes_avx2(data, size, needle, needle_size);
+        if(is_sse2) return find_bytes_sse2(data, size, needle, needle_size);
+#       endif
+        return find_bytes_scalar(data, size, needle, needle_size);
+    }
+
+    /** \brief Найти подстроку
+     *
+     * Результат совпадает с std::string::find
+     * \param text Текст
+     * \param needle Искомая подстрока
+     * \param pos Позиция начала поиска
+     * \return Позиция подстроки или std::string::npos
+     */
+    inline size_t find_bytes(
+            const std::string &text,
+            const std::string &needle,
+            const size_t pos = 0) {
+        if(pos > text.size()) return std::string::npos;
+        const size_t size = text.size() - pos;
+        const size_t found = find_bytes(text.data() + pos, size, needle.data(), needle.size());
+        if(found == size && !(needle.empty() && size == 0)) return std::string::npos;
+        return pos + found;
+    }
+}
+#endif // FOREXPROSTOOLS_BYTE_SCAN_HPP_INCLUDED
@@ -0,0 +1,171 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_CURRENCY_MASK_HPP_INCLUDED
+#define FOREXPROSTOOLS_CURRENCY_MASK_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#ifndef FOREXPROSTOOLS_USE_AVX2
+#define FOREXPROSTOOLS_USE_AVX2
+#endif
+#include <immintrin.h>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /** \brief Реестр битов валют
+     *
+     * Каждой валюте назначается свой бит в 64-битной маске.
+     * Биты назначаются по мере появления валют, поэтому реестр хранит до 64 валют.
+     */
+    class CurrencyRegistry {
+    private:
+        std::unordered_map<uint32_t, uint64_t> masks_;
+
+    public:
+        enum {
+            MAX_CURRENCIES = 64,    /**< Максимальное количество валют в реестре */
+        };
+
+        CurrencyRegistry() {};
+
+        /** \brief Получить маску валюты, назначив ей бит при необходимости
+         * \param currency Код валюты
+         * \return Маска валюты или 0, если реестр заполнен или код неверен
+         */
+        uint64_t add(const CurrencyCode &currency) {
+            if(!currency.is_valid()) return 0;
+            auto it = masks_.find(currency.get_code());
+            if(it != masks_.end()) return it->second;
+            if(masks_.size() >= MAX_CURRENCIES) return 0;
+            const uint64_t mask = (uint64_t)1 << masks_.size();
+            masks_[currency.get_code()] = mask;
+            return mask;
+        }
+
+        /** \brief Получить маску валюты
+         * \param currency Код валюты
+         * \return Маска валюты или 0, если валюты нет в реестре
+         */
+        uint64_t get(const CurrencyCode &currency) const {
+            auto it = masks_.find(currency.get_code());
+            if(it == masks_.end()) return 0;
+            return it->second;
+        }
+
+        /** \brief Получить маску валюты по имени
+         * \param currency Имя валюты
+         * \return Маска валюты или 0, если валюты нет в реестре
+         */
+        uint64_t get(const std::string &currency) const {
+            const uint32_t code = CurrencyCode::pack(currency);
+            if(code == 0) return 0;
+            auto it = masks_.find(code);
+            if(it == masks_.end()) return 0;
+            return it->second;
+        }
+    };
+
+    /** \brief Объединить маски валют по уровням силы новостей (скалярная версия)
+     * \param masks Столбец масок валют новостей
+     * \param levels Столбец уровней силы новостей
+     * \param size Количество новостей
+     * \param level_masks Маски валют для уровней LOW, MODERATE и HIGH
+     */
+    inline void get_level_masks_scalar(
+            const uint64_t *masks,
+            const int64_t *levels,
+            const size_t size,
+            uint64_t level_masks[HIGH + 1]) {
+        for(int level = LOW; level <= HIGH; ++level) level_masks[level] = 0;
+        for(size_t i = 0; i < size; ++i) {
+            if(levels[i] < LOW || levels[i] > HIGH) continue;
+            level_masks[levels[i]] |= masks[i];
+        }
+    }
+
+#   if defined(FOREXPROSTOOLS_USE_AVX2)
+    /** \brief Объединить маски валют по уровням силы новостей (AVX2)
+     *
+     * За одну итерацию обрабатываются четыре новости.
+     * \param masks Столбец масок валют новостей
+     * \param levels Столбец уровней силы новостей
+     * \param size Количество новостей
+     * \param level_masks Маски валют для уровней LOW, MODERATE и HIGH
+     */
+    __attribute__((target("avx2")))
+    inline void get_level_masks_avx2(
+            const uint64_t *masks,
+            const int64_t *levels,
+            const size_t size,
+            uint64_t level_masks[HIGH + 1]) {
+        const __m256i low = _mm256_set1_epi64x(LOW);
+        const __m256i moderate = _mm256_set1_epi64x(MODERATE);
+        const __m256i high = _mm256_set1_epi64x(HIGH);
+        __m256i acc_low = _mm256_setzero_si256();
+        __m256i acc_moderate = _mm256_setzero_si256();
+        __m256i acc_high = _mm256_setzero_si256();
+        size_t i = 0;
+        for(; i + 4 <= size; i += 4) {
+            const __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+            const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(levels + i));
+            acc_low = _mm256_or_si256(acc_low, _mm256_and_si256(m, _mm256_cmpeq_epi64(l, low)));
+            acc_moderate = _mm256_or_si256(acc_moderate, _mm256_and_si256(m, _mm256_cmpeq_epi64(l, moderate)));
+            acc_high = _mm256_or_si256(acc_high, _mm256_and_si256(m, _mm256_cmpeq_epi64(l, high)));
+        }
+        uint64_t lanes[3][4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[0]), acc_low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[1]), acc_moderate);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[2]), acc_high);
+        get_level_masks_scalar(masks + i, levels + i, size - i, level_masks);
+        for(int level = LOW; level <= HIGH; ++level) {
+            level_masks[level] |= lanes[level][0] | lanes[level][1] | lanes[level][2] | lanes[level][3];
+        }
+    }
+#   endif
+
+    /** \brief Объединить маски валют по уровням силы новостей
+     *
+     * Если процессор поддерживает AVX2, используется векторная версия.
+     * \param masks Столбец масок валют новостей
+     * \param levels Столбец уровней силы новостей
+     * \param size Количество новостей
+     * \param level_masks Маски валют для уровней LOW, MODERATE и HIGH
+     */
+    inline void get_level_masks(
+            const uint64_t *masks,
+            const int64_t *levels,
+            const size_t size,
+            uint64_t level_masks[HIGH + 1]) {
+#       if defined(FOREXPROSTOOLS_USE_AVX2)
+        static const bool is_avx2 = __builtin_cpu_supports("avx2");
+        if(is_avx2) {
+            get_level_masks_avx2(masks, levels, size, level_masks);
+            return;
+        }
+#       endif
+        get_level_masks_scalar(masks, levels, size, level_masks);
+    }
+}
+#endif // FOREXPROSTOOLS_CURRENCY_MASK_HPP_INCLUDED
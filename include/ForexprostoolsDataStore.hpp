@@ -25,7 +25,22 @@
 #define FOREXPROSTOOLS_DATA_STOR_HPP_INCLUDED
 //------------------------------------------------------------------------------
 #include <ForexprostoolsApiEasy.hpp>
+#include <ForexprostoolsDataStoreIndex.hpp>
+#include <ForexprostoolsWriteLog.hpp>
+#include <ForexprostoolsNewsPredicate.hpp>
+#include <ForexprostoolsCurrencyMask.hpp>
+#include <ForexprostoolsSurpriseIndex.hpp>
+#include <ForexprostoolsStatistics.hpp>
+#include <ForexprostoolsNewsColumns.hpp>
 #include "xquotes_json_storage.hpp"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <map>
+#include <set>
 //------------------------------------------------------------------------------
 namespace ForexprostoolsDataStore {
     using namespace ForexprostoolsApiEasy;
@@ -34,100 +49,1191 @@ namespace ForexprostoolsDataStore {
      */
     class DataStore {
     private:
-        xquotes_json_storage::JsonStorage iStorage;
+        std::unique_ptr<xquotes_json_storage::JsonStorage> iStorage;
         xtime::timestamp_t timestamp_beg = 0;   /**< Метка времени начала исторических данных */
         xtime::timestamp_t timestamp_end = 0;   /**< Метка времени конца исторических данных */
-        NewsList hist;                          /**< Исторические данные */
+        NewsColumns hist;                       /**< Исторические данные (по столбцам) */
+        std::string path_;                      /**< Путь к файлу хранилища */
+        DayIndex day_index_;                    /**< Индекс дней хранилища */
+        uint32_t indent_past_ = 0;              /**< Отступ данных хранилища к началу истории */
+        uint32_t indent_future_ = 0;            /**< Отступ данных хранилища к концу истории */
+        bool is_indent_ = false;                /**< Флаг установки отступа */
 
-        /** \brief Разбить имя валютной пары на составляющие валюты
-         * \param pair_name имя валютной пары
-         * \param currency_1 первая валюта валютной пары
-         * \param currency_2 вторая валюта валютной пары
-         * \return вернет 0 в случае успеха
+        std::unique_ptr<WriteLog> write_log_;   /**< Журнал записи, если используется */
+        std::unique_ptr<FileLock> store_lock_;  /**< Межпроцессная блокировка хранилища */
+        std::map<xtime::timestamp_t, std::string> log_days_; /**< Дни из журнала, которые еще не перенесены в хранилище */
+        bool is_log_writer_ = false;            /**< Флаг процесса-писателя журнала */
+        bool is_write_ = false;                 /**< Процесс писал в хранилище, только такой процесс сохраняет индекс дней */
+        std::set<xtime::timestamp_t> index_changed_days_; /**< Дни, измененные в хранилище после сохранения индекса дней */
+
+        EventIndex event_index_;                /**< Индекс событий для поиска ближайших новостей */
+        bool is_event_index_ = false;           /**< Флаг готовности индекса событий */
+        std::set<xtime::timestamp_t> event_dirty_days_; /**< Дни, изменившиеся после построения индекса событий */
+
+        SurpriseIndex surprise_index_;          /**< Индекс производных показателей новостей */
+        bool is_surprise_index_ = false;        /**< Флаг готовности индекса производных показателей */
+        std::set<xtime::timestamp_t> surprise_dirty_days_; /**< Дни, изменившиеся после построения индекса показателей */
+
+        /** \brief Отметить изменение дня для зависимых индексов
+         * \param day_timestamp Метка времени начала дня
+         */
+        void mark_day_changed(const xtime::timestamp_t day_timestamp) {
+            if(is_event_index_) event_dirty_days_.insert(day_timestamp);
+            if(is_surprise_index_) surprise_dirty_days_.insert(day_timestamp);
+        }
+
+        /** \brief Получить размер файла
+         * \param file_name Имя файла
+         * \return Размер файла или 0, если файла нет
+         */
+        static uint64_t get_file_size(const std::string &file_name) {
+            std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+            if(!file) return 0;
+            std::streamoff size = file.tellg();
+            return size > 0 ? (uint64_t)size : 0;
+        }
+
+        /** \brief Получить имя файла индекса дней
+         * \return Имя файла индекса
+         */
+        std::string get_index_file_name() const {
+            return path_ + ".idx";
+        }
+
+        /** \brief Загрузить индекс дней
+         *
+         * Если файла индекса нет, индекс будет построен заново по хранилищу.
+         * Если индекс устарел, заново строится только карта дней с новостями, а дни без новостей,
+         * хеши и сводки оставшихся дней берутся из файла (см. DayIndex::load).
+         * Построенный индекс сохранит в файл только процесс, который пишет в хранилище (см. save).
+         */
+        void init_day_index() {
+            const uint64_t storage_size = get_file_size(path_);
+            bool is_stale = false;
+            if(day_index_.load(get_index_file_name(), storage_size, is_stale)) {
+                if(!is_stale) return;
+                day_index_.clear_days();
+            } else {
+                day_index_.clear();
+            }
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(iStorage->get_min_max_timestamp(min_timestamp, max_timestamp) == xquotes_common::OK) {
+                for(xtime::timestamp_t t = min_timestamp; t <= max_timestamp; t += xtime::SECONDS_IN_DAY) {
+                    if(iStorage->check_timestamp(t)) day_index_.set_day(t);
+                }
+            }
+            day_index_.remove_missing_days();
+        }
+
+        /** \brief Открыть файл хранилища заново
+         *
+         * Нужно читателю после того, как писатель перенес журнал в хранилище.
+         */
+        void reopen_storage() {
+            iStorage.reset();
+            iStorage.reset(new xquotes_json_storage::JsonStorage(path_));
+            if(is_indent_) iStorage->set_indent(indent_past_, indent_future_);
+            init_day_index();
+            is_event_index_ = false;
+            is_surprise_index_ = false;
+        }
+
+        /** \brief Проверить, не перенес ли писатель журнал в хранилище
+         *
+         * Вызывается читателем под разделяемой блокировкой. Если поколение журнала сменилось,
+         * файл хранилища открывается заново, а дни старого поколения журнала забываются,
+         * так как писатель уже перенес их в хранилище.
          */
-        inline int get_currencies(std::string pair_name, std::string &currency_1, std::string &currency_2) {
-            const size_t NAME_LEN = 6;
-            if(pair_name.size() < NAME_LEN) return INVALID_PARAMETER;
-            pair_name.erase(std::remove_if(pair_name.begin(), pair_name.end(), [](int c) {
-                return !std::isalpha(c);
-            }), pair_name.end());
-            const std::string str_del = "frx";
-            std::string::size_type pos = pair_name.find(str_del);
-            while(pos != std::string::npos) {
-                pair_name.erase(pos, str_del.size());
-                pos = pair_name.find(str_del, pos + 1);
-            }
-            std::transform(pair_name.begin(), pair_name.end(),pair_name.begin(), ::toupper);
-            if(pair_name.size() != NAME_LEN) return INVALID_PARAMETER;
-            currency_1 = pair_name.substr(0, 3);
-            currency_2 = pair_name.substr(3, 3);
+        void check_log_generation() {
+            uint64_t generation = 0;
+            if(!write_log_->get_generation(generation)) return;
+            if(generation == write_log_->get_read_generation()) return;
+            write_log_->set_read_generation(generation);
+            log_days_.clear();
+            reopen_storage();
+        }
+
+        /** \brief Получить JSON новостей за день
+         *
+         * Дни, которые есть в журнале записи, читаются из журнала.
+         * Читатель читает файл хранилища под разделяемой блокировкой
+         * и перед чтением открывает его заново, если писатель успел перенести журнал в хранилище.
+         * \param j JSON массив новостей
+         * \param day_timestamp Метка времени начала дня
+         * \return Вернет 0 в случае успеха
+         */
+        int get_day_json(nlohmann::json &j, const xtime::timestamp_t day_timestamp) {
+            if(write_log_) {
+                auto it = log_days_.find(day_timestamp);
+                if(it != log_days_.end()) {
+                    j = nlohmann::json::parse(it->second);
+                    return OK;
+                }
+                if(!is_log_writer_) {
+                    FileLockGuard guard(*store_lock_, false);
+                    if(!guard.is_lock()) return NO_DATA_ACCESS;
+                    check_log_generation();
+                    return iStorage->get_json(j, day_timestamp);
+                }
+            }
+            return iStorage->get_json(j, day_timestamp);
+        }
+
+        /** \brief Записать JSON новостей за день
+         * \param j JSON массив новостей
+         * \param data JSON массив новостей в виде строки
+         * \param day_timestamp Метка времени начала дня
+         * \param hash Хеш содержимого дня
+         * \return Вернет 0 в случае успеха
+         */
+        int write_day_json(
+                nlohmann::json &j,
+                const std::string &data,
+                const xtime::timestamp_t day_timestamp,
+                const uint64_t hash) {
+            int err = OK;
+            if(write_log_) {
+                if(!is_log_writer_) return INVALID_PARAMETER;
+                if(!write_log_->append(day_timestamp, data)) return WRITE_ERROR;
+                log_days_[day_timestamp] = data;
+            } else {
+                /* хеш и сводку дня убираем из файла индекса до изменения хранилища,
+                 * чтобы после сбоя в индексе не осталось данных старого содержимого дня */
+                if(index_changed_days_.insert(day_timestamp).second) {
+                    uint64_t old_hash = 0;
+                    if(day_index_.get_hash(day_timestamp, old_hash) || day_index_.get_summary(day_timestamp) != NULL) {
+                        const std::vector<xtime::timestamp_t> list_days(index_changed_days_.begin(), index_changed_days_.end());
+                        if(!day_index_.save_before_change(get_index_file_name(), get_file_size(path_), list_days)) {
+                            index_changed_days_.erase(day_timestamp);
+                            return WRITE_ERROR;
+                        }
+                    }
+                }
+                err = iStorage->write_json(j, day_timestamp);
+                if(err != xquotes_common::OK) return err;
+                is_storage_changed_ = true;
+            }
+            is_write_ = true;
+            day_index_.set_day(day_timestamp);
+            day_index_.set_hash(day_timestamp, hash);
+            set_day_summary(j, day_timestamp);
+            mark_day_changed(day_timestamp);
             return OK;
         }
+
+        /** \brief Посчитать и запомнить сводку новостей дня
+         * \param j JSON массив новостей
+         * \param day_timestamp Метка времени начала дня
+         * \return Вернет true в случае успеха
+         */
+        bool set_day_summary(const nlohmann::json &j, const xtime::timestamp_t day_timestamp) {
+            DaySummary summary;
+            try {
+                for(size_t i = 0; i < j.size(); ++i) {
+                    const nlohmann::json &item = j[i];
+                    summary.add(
+                        item.at("currency").get_ref<const std::string&>(),
+                        item.at("volatility").get<int>(),
+                        item.at("timestamp").get<xtime::timestamp_t>(),
+                        item.find("previous") != item.end(),
+                        item.find("actual") != item.end(),
+                        item.find("forecast") != item.end());
+                }
+            }
+            catch(...) {
+                day_index_.remove_summary(day_timestamp);
+                return false;
+            }
+            day_index_.set_summary(day_timestamp, summary);
+            return true;
+        }
+
+        /** \brief Получить сводку новостей дня
+         *
+         * Если сводки дня еще нет в индексе, она считается по хранилищу и запоминается в индексе в памяти.
+         * В файл индекса такие сводки сохраняет процесс-писатель (см. fill_day_index).
+         * \param day_timestamp Метка времени начала дня
+         * \return Указатель на сводку или NULL, если за день нет новостей или их не удалось прочитать
+         */
+        const DaySummary *find_day_summary(const xtime::timestamp_t day_timestamp) {
+            if(!day_index_.check_timestamp(day_timestamp)) return NULL;
+            const DaySummary *summary = day_index_.get_summary(day_timestamp);
+            if(summary != NULL) return summary;
+            nlohmann::json j;
+            try {
+                if(get_day_json(j, day_timestamp) != xquotes_common::OK) return NULL;
+            }
+            catch(...) {
+                return NULL;
+            }
+            if(!set_day_summary(j, day_timestamp)) return NULL;
+            return day_index_.get_summary(day_timestamp);
+        }
+
+        /** \brief Дополнить индекс дней хешами и сводками
+         *
+         * Вызывается процессом-писателем перед сохранением индекса. Дни, для которых в индексе
+         * еще нет хеша или сводки (например, записанные до появления сводок или после устаревшего индекса),
+         * читаются из хранилища один раз, после чего хеши и сводки сохраняются в файл индекса.
+         * Читатели индекс не сохраняют, поэтому без этого они считали бы такие дни заново при каждом запуске.
+         */
+        void fill_day_index() {
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return;
+            for(xtime::timestamp_t t = min_timestamp; t <= max_timestamp; t += xtime::SECONDS_IN_DAY) {
+                if(!day_index_.check_timestamp(t)) continue;
+                uint64_t hash = 0;
+                const bool is_hash = day_index_.get_hash(t, hash);
+                if(is_hash && day_index_.get_summary(t) != NULL) continue;
+                nlohmann::json j;
+                try {
+                    if(get_day_json(j, t) != xquotes_common::OK) continue;
+                    if(!is_hash) day_index_.set_hash(t, get_hash(j.dump()));
+                }
+                catch(...) {
+                    continue;
+                }
+                if(day_index_.get_summary(t) == NULL) set_day_summary(j, t);
+            }
+        }
+
+        std::vector<News> buffer_news_;         /**< Буфер для чтения новостей за день */
+        std::vector<xtime::timestamp_t> buffer_days_;       /**< Буфер меток времени дней для чтения нескольких дней */
+        std::vector<std::vector<News>> buffer_days_news_;   /**< Буфер новостей нескольких дней */
+        std::vector<int> buffer_days_err_;                  /**< Буфер кодов ошибок чтения нескольких дней */
+
+        uint32_t read_threads_ = 1;             /**< Количество потоков чтения дней */
+        bool is_storage_changed_ = false;       /**< В буфере хранилища есть дни, еще не записанные в файл */
+        const size_t READ_THREAD_MIN_DAYS = 8;  /**< Минимальное количество дней на один поток чтения */
+
+        /** \brief Прочитать и декодировать дни в нескольких потоках
+         *
+         * Общая часть read_days и map_reduce. Перед чтением буфер хранилища записывается в файл,
+         * а читатель журнала захватывает разделяемую блокировку и проверяет поколение журнала.
+         * Каждый поток открывает хранилище для чтения отдельно, берет из общей очереди следующие дни
+         * и сразу декодирует их, поэтому ожидание чтения одних дней перекрывается чтением и декодированием других.
+         * \param list_days Метки времени начала дней
+         * \param num_threads Количество потоков
+         * \param block_size Количество дней, которые поток берет из очереди за один раз
+         * \param f Функция вызывается в потоке чтения для каждого дня и получит номер потока,
+         * номер дня в list_days, код ошибки чтения и новости дня (буфер потока, содержимое можно забрать через swap)
+         * \return Вернет 0 в случае успеха или NO_DATA_ACCESS, если не удалось захватить блокировку
+         */
+        template<class T>
+        int read_days_parallel(
+                const std::vector<xtime::timestamp_t> &list_days,
+                const uint32_t num_threads,
+                const size_t block_size,
+                T f) {
+            /* потоки читают файл хранилища, поэтому буфер хранилища должен быть записан */
+            if(!write_log_ && is_storage_changed_) {
+                iStorage->save();
+                is_storage_changed_ = false;
+            }
+            std::unique_ptr<FileLockGuard> guard;
+            if(write_log_ && !is_log_writer_) {
+                guard.reset(new FileLockGuard(*store_lock_, false));
+                if(!guard->is_lock()) return NO_DATA_ACCESS;
+                check_log_generation();
+            }
+
+            std::atomic<size_t> next_index(0);
+            std::vector<std::thread> workers;
+            for(uint32_t n = 0; n < num_threads; ++n) {
+                workers.push_back(std::thread([&, n]() {
+                    xquotes_json_storage::JsonStorage reader(path_);
+                    std::vector<News> list_news;
+                    nlohmann::json j;
+                    while(true) {
+                        const size_t index = next_index.fetch_add(block_size);
+                        if(index >= list_days.size()) break;
+                        const size_t end_index = std::min(index + block_size, list_days.size());
+                        for(size_t i = index; i < end_index; ++i) {
+                            const xtime::timestamp_t t = list_days[i];
+                            int err = OK;
+                            try {
+                                /* дни журнала записи берутся из памяти, остальные из файла хранилища */
+                                auto it = log_days_.find(t);
+                                if(it != log_days_.end()) {
+                                    j = nlohmann::json::parse(it->second);
+                                } else {
+                                    err = reader.get_json(j, t);
+                                }
+                                if(err == xquotes_common::OK) {
+                                    list_news.resize(j.size());
+                                    for(size_t k = 0; k < list_news.size(); ++k) {
+                                        decode_news(j[k], list_news[k]);
+                                    }
+                                }
+                            }
+                            catch(...) {
+                                err = PARSER_ERROR;
+                            }
+                            if(err != OK) list_news.clear();
+                            f(n, i, err, list_news);
+                        }
+                    }
+                }));
+            }
+            for(size_t n = 0; n < workers.size(); ++n) {
+                workers[n].join();
+            }
+            return OK;
+        }
+
+        /** \brief Прочитать новости нескольких дней
+         *
+         * Если разрешено несколько потоков чтения (set_read_threads), дни читаются параллельно методом read_days_parallel.
+         * Результат совпадает с последовательным чтением дней методом read_news.
+         * \param list_days Метки времени начала дней
+         * \param days_news Новости каждого дня
+         * \param list_err Коды ошибок чтения каждого дня
+         */
+        void read_days(
+                const std::vector<xtime::timestamp_t> &list_days,
+                std::vector<std::vector<News>> &days_news,
+                std::vector<int> &list_err) {
+            if(days_news.size() < list_days.size()) days_news.resize(list_days.size());
+            list_err.assign(list_days.size(), OK);
+            uint32_t num_threads = read_threads_;
+            if(num_threads == 0) num_threads = std::max(1U, std::thread::hardware_concurrency());
+            num_threads = (uint32_t)std::min((size_t)num_threads, list_days.size() / READ_THREAD_MIN_DAYS);
+            if(num_threads <= 1) {
+                for(size_t i = 0; i < list_days.size(); ++i) {
+                    list_err[i] = read_news(days_news[i], list_days[i]);
+                }
+                return;
+            }
+            const int err = read_days_parallel(list_days, num_threads, 1,
+                    [&](const uint32_t, const size_t i, const int day_err, std::vector<News> &list_news) {
+                days_news[i].swap(list_news);
+                list_err[i] = day_err;
+            });
+            if(err != OK) {
+                for(size_t i = 0; i < list_days.size(); ++i) {
+                    days_news[i].clear();
+                }
+                list_err.assign(list_days.size(), err);
+            }
+        }
+
+        CurrencyRegistry currency_registry_;    /**< Биты валют для проверки нескольких валютных пар */
+        std::vector<uint64_t> column_masks_;    /**< Столбец масок валют новостей окна */
+        std::vector<uint64_t> currency_id_masks_; /**< Маски валют по номерам в таблице валют hist */
+        std::vector<int64_t> column_levels_;    /**< Столбец уровней силы новостей окна */
+        std::vector<uint64_t> pair_masks_;      /**< Маски валют валютных пар */
+
+        /** \brief Декодировать новость из JSON
+         *
+         * Строки присваиваются без создания временных копий,
+         * поэтому при повторном использовании объекта News память строк не перераспределяется.
+         * \param item JSON объект новости
+         * \param news Новость
+         */
+        static void decode_news(const nlohmann::json &item, News &news) {
+            news.name = item.at("name").get_ref<const std::string&>();
+            news.currency = item.at("currency").get_ref<const std::string&>();
+            news.country = item.at("country").get_ref<const std::string&>();
+            news.level_volatility = item.at("volatility").get<int>();
+            news.timestamp = item.at("timestamp").get<xtime::timestamp_t>();
+            auto it_previous = item.find("previous");
+            auto it_actual = item.find("actual");
+            auto it_forecast = item.find("forecast");
+            if(it_previous != item.end()) {
+                news.previous = it_previous->get<double>();
+                news.is_previous = true;
+            } else {
+                news.previous = 0;
+                news.is_previous = false;
+            }
+            if(it_actual != item.end()) {
+                news.actual = it_actual->get<double>();
+                news.is_actual = true;
+            } else {
+                news.actual = 0;
+                news.is_actual = false;
+            }
+            if(it_forecast != item.end()) {
+                news.forecast = it_forecast->get<double>();
+                news.is_forecast = true;
+            } else {
+                news.forecast = 0;
+                news.is_forecast = false;
+            }
+        }
+
+        /** \brief Закодировать новости в JSON
+         * \param list_news Список новостей
+         * \param j JSON массив новостей
+         */
+        static void encode_news(const std::vector<News> &list_news, nlohmann::json &j) {
+            j = nlohmann::json::array();
+            for(size_t i = 0; i < list_news.size(); ++i) {
+                j[i]["name"] = list_news[i].name;
+                j[i]["currency"] = list_news[i].currency;
+                j[i]["country"] = list_news[i].country;
+                j[i]["volatility"] = list_news[i].level_volatility;
+                j[i]["timestamp"] = list_news[i].timestamp;
+                if(list_news[i].is_previous) j[i]["previous"] = list_news[i].previous;
+                if(list_news[i].is_actual) j[i]["actual"] = list_news[i].actual;
+                if(list_news[i].is_forecast) j[i]["forecast"] = list_news[i].forecast;
+            }
+        }
+
+        /** \brief Проверить, совпадает ли содержимое дня с уже записанным
+         * \param day_timestamp Метка времени начала дня
+         * \param hash Хеш нового содержимого дня
+         * \return Вернет true, если день уже записан с таким же содержимым
+         */
+        bool is_same_day(const xtime::timestamp_t day_timestamp, const uint64_t hash) {
+            uint64_t old_hash = 0;
+            if(get_day_hash(day_timestamp, old_hash) != OK) return false;
+            return old_hash == hash;
+        }
+
+        /** \brief Перебрать новости, подходящие под условие
+         *
+         * Условие проверяется по JSON объекту новости, декодируются только подходящие новости.
+         * Дни, которых нет в индексе, не читаются.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param predicate Условие отбора новостей
+         * \param f Функция получит JSON объект подходящей новости и вернет false, чтобы прекратить перебор
+         * \return Вернет 0 в случае успеха
+         */
+        template<class T>
+        int for_each_news(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const NewsPredicate &predicate,
+                T f) {
+            if(beg_timestamp > end_timestamp) return INVALID_PARAMETER;
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
+            const xtime::timestamp_t start_timestamp = std::max(xtime::get_first_timestamp_day(beg_timestamp), min_timestamp);
+            const xtime::timestamp_t stop_timestamp = std::min(xtime::get_first_timestamp_day(end_timestamp), max_timestamp);
+            nlohmann::json j;
+            for(xtime::timestamp_t t = start_timestamp; t <= stop_timestamp; t += xtime::SECONDS_IN_DAY) {
+                if(!day_index_.check_timestamp(t)) continue;
+                try {
+                    if(get_day_json(j, t) != xquotes_common::OK) continue;
+                    for(size_t i = 0; i < j.size(); ++i) {
+                        const nlohmann::json &item = j[i];
+                        const xtime::timestamp_t timestamp = item.at("timestamp").get<xtime::timestamp_t>();
+                        if(timestamp < beg_timestamp || timestamp > end_timestamp) continue;
+                        if(!predicate.check(item)) continue;
+                        if(!f(item)) return OK;
+                    }
+                }
+                catch(...) {
+                    return PARSER_ERROR;
+                }
+            }
+            return OK;
+        }
+
+        /** \brief Добавить события дня в индекс событий
+         * \param day_timestamp Метка времени начала дня
+         */
+        void add_day_events(const xtime::timestamp_t day_timestamp) {
+            nlohmann::json j;
+            try {
+                if(get_day_json(j, day_timestamp) != xquotes_common::OK) return;
+                for(size_t i = 0; i < j.size(); ++i) {
+                    const nlohmann::json &item = j[i];
+                    event_index_.add(
+                        item.at("currency").get_ref<const std::string&>(),
+                        item.at("volatility").get<int>(),
+                        item.at("timestamp").get<xtime::timestamp_t>());
+                }
+            }
+            catch(...) {}
+        }
+
+        /** \brief Подготовить индекс событий
+         *
+         * При первом вызове индекс строится по всему хранилищу,
+         * затем в нем обновляются только дни, которые были записаны после построения.
+         */
+        void update_event_index() {
+            if(!is_event_index_) {
+                event_index_.clear();
+                event_dirty_days_.clear();
+                xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+                if(day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) {
+                    for(xtime::timestamp_t t = min_timestamp; t <= max_timestamp; t += xtime::SECONDS_IN_DAY) {
+                        if(day_index_.check_timestamp(t)) add_day_events(t);
+                    }
+                }
+                event_index_.sort();
+                is_event_index_ = true;
+                return;
+            }
+            if(event_dirty_days_.empty()) return;
+            for(auto it = event_dirty_days_.begin(); it != event_dirty_days_.end(); ++it) {
+                event_index_.remove(*it, *it + xtime::SECONDS_IN_DAY);
+                add_day_events(*it);
+            }
+            event_dirty_days_.clear();
+            event_index_.sort();
+        }
+
+        /** \brief Подготовить индекс производных показателей
+         *
+         * При первом вызове индекс строится по всему хранилищу,
+         * затем пересчитываются только ряды новостей из дней, записанных после построения.
+         */
+        void update_surprise_index() {
+            if(!is_surprise_index_) {
+                surprise_index_.clear();
+                surprise_dirty_days_.clear();
+                xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+                if(day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) {
+                    /* дни читаются блоками, чтобы не держать в памяти все хранилище */
+                    const size_t BLOCK_DAYS = 256;
+                    for(xtime::timestamp_t t = min_timestamp; t <= max_timestamp; ) {
+                        buffer_days_.clear();
+                        for(; t <= max_timestamp && buffer_days_.size() < BLOCK_DAYS; t += xtime::SECONDS_IN_DAY) {
+                            if(day_index_.check_timestamp(t)) buffer_days_.push_back(t);
+                        }
+                        read_days(buffer_days_, buffer_days_news_, buffer_days_err_);
+                        for(size_t i = 0; i < buffer_days_.size(); ++i) {
+                            if(buffer_days_err_[i] == OK) surprise_index_.add_day(buffer_days_[i], buffer_days_news_[i]);
+                        }
+                    }
+                }
+                surprise_index_.update();
+                is_surprise_index_ = true;
+                return;
+            }
+            if(surprise_dirty_days_.empty()) return;
+            for(auto it = surprise_dirty_days_.begin(); it != surprise_dirty_days_.end(); ++it) {
+                surprise_index_.remove_day(*it);
+                if(read_news(buffer_news_, *it) == OK) surprise_index_.add_day(*it, buffer_news_);
+            }
+            surprise_dirty_days_.clear();
+            surprise_index_.update();
+        }
+
+        /** \brief Получить новость события по метке времени
+         * \param event_timestamp Метка времени события
+         * \param currencies Валюты новостей
+         * \param min_level_volatility Минимальный уровень силы новости
+         * \param news Новость
+         * \return Вернет 0 в случае успеха
+         */
+        int get_event(
+                const xtime::timestamp_t event_timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            int err = read_news(buffer_news_, event_timestamp);
+            if(err != OK) return err;
+            for(size_t i = 0; i < buffer_news_.size(); ++i) {
+                if(buffer_news_[i].timestamp != event_timestamp) continue;
+                if(!check_event(buffer_news_[i], currencies, min_level_volatility)) continue;
+                news = buffer_news_[i];
+                return OK;
+            }
+            return NO_DATA_ACCESS;
+        }
+
     public:
 
         /** \brief Инициализировать базу данных новостей
          * \param _path путь к базе данных
          */
-        DataStore(const std::string &path) : iStorage(path) {};
+        DataStore(const std::string &path) : iStorage(new xquotes_json_storage::JsonStorage(path)), path_(path) {
+            init_day_index();
+        };
+
+        ~DataStore() {
+            save();
+        }
 
         /** \brief Проверить наличие новостей за торговый день по метке времени
+         *
+         * Проверка выполняется по индексу дней и не обращается к хранилищу.
          * \param timestamp метка времени
          * \return вернет true если файл есть
          */
         bool check_timestamp(const xtime::timestamp_t timestamp) {
-            return iStorage.check_timestamp(timestamp);
+            return day_index_.check_timestamp(timestamp);
         }
 
         /** \brief Узнать максимальную и минимальную метку времени подфайлов
+         *
+         * Метки времени берутся из индекса дней и не требуют чтения хранилища.
          * \param min_timestamp Метка времени в начале дня начала исторических данных
          * \param max_timestamp Метка времени в начале дня конца исторических данных
-         * \return Вернет 0 в случае успеха, иначе см. код ошибок в xquotes_common.hpp
+         * \return Вернет 0 в случае успеха или NO_DATA_ACCESS, если хранилище пустое
          */
         int get_min_max_timestamp(xtime::timestamp_t &min_timestamp, xtime::timestamp_t &max_timestamp) {
-            return iStorage.get_min_max_timestamp(min_timestamp, max_timestamp);
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
+            return OK;
+        }
+
+        /** \brief Отметить день, для которого сервер подтвердил отсутствие новостей
+         *
+         * Отметка хранится в индексе дней и снимается, если за день будут записаны новости.
+         * \param timestamp Метка времени дня
+         */
+        void set_empty_day(const xtime::timestamp_t timestamp) {
+            is_write_ = true;
+            day_index_.set_empty_day(xtime::get_first_timestamp_day(timestamp));
+        }
+
+        /** \brief Проверить, известно ли, что за день нет новостей
+         *
+         * Проверка выполняется по индексу дней и не обращается к хранилищу.
+         * \param timestamp Метка времени
+         * \return Вернет true, если день был отмечен методом set_empty_day
+         */
+        bool check_empty_day(const xtime::timestamp_t timestamp) {
+            return day_index_.check_empty_day(timestamp);
+        }
+
+        /** \brief Получить список дней, за которые нет новостей
+         *
+         * Дни, отмеченные методом set_empty_day, в список не попадают.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param list_timestamp Список меток времени начала дней без новостей
+         * \param is_skip_day_off Флаг пропуска выходных дней
+         */
+        void get_missing_days(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                std::vector<xtime::timestamp_t> &list_timestamp,
+                const bool is_skip_day_off = true) {
+            day_index_.get_missing_days(beg_timestamp, end_timestamp, list_timestamp, is_skip_day_off);
+        }
+
+        /** \brief Установить отступ данных от дня загрузки
+         *
+         * Отсутп позволяет загрузить используемую область данных заранее.
+         * Это позволит получать данные в пределах области без повторной загрузки подфайлов.
+         * При этом, цесли данные выйдут за пределы области, то область сместится, произойдет подзагрузка
+         * недостающих данных.
+         * \param indent_timestamp_past Отступ от даты загрузки в днях к началу исторических данных
+         * \param indent_timestamp_future Отступ от даты загрузки в днях к концу исторических данных
+         */
+        void set_indent(
+                const uint32_t indent_timestamp_past,
+                const uint32_t indent_timestamp_future) {
+            indent_past_ = indent_timestamp_past;
+            indent_future_ = indent_timestamp_future;
+            is_indent_ = true;
+            iStorage->set_indent(indent_timestamp_past, indent_timestamp_future);
+        }
+
+        /** \brief Сохранить данные
+         *
+         * Метод  принудительно сохраняет все данные, которые еще не записаны в файл а находятся только в буфере.
+         * Если используется журнал записи, писатель переносит журнал в хранилище под исключительной блокировкой,
+         * а у читателя метод ничего не делает. Журнал начинается заново, только если все его дни
+         * попали в файл хранилища, иначе он сохраняется до следующего вызова save().
+         * Пустой журнал не переносится и не начинается заново, поэтому читатели не переоткрывают хранилище.
+         * \return Вернет 0 в случае успеха
+         */
+        int save() {
+            if(write_log_) {
+                if(!is_log_writer_) return OK;
+                FileLockGuard guard(*store_lock_, true);
+                if(!guard.is_lock()) return NO_DATA_ACCESS;
+                /* переносить нечего: поколение журнала не меняем, иначе все читатели заново откроют хранилище */
+                if(log_days_.empty() && write_log_->is_empty()) {
+                    if(day_index_.is_modified()) {
+                        day_index_.save(get_index_file_name(), get_file_size(path_));
+                    }
+                    return OK;
+                }
+                /* до переноса журнала убираем хеши и сводки его дней из файла индекса (см. DayIndex::load) */
+                std::vector<xtime::timestamp_t> list_days;
+                for(auto it = log_days_.begin(); it != log_days_.end(); ++it) {
+                    list_days.push_back(it->first);
+                }
+                if(!day_index_.save_before_change(get_index_file_name(), get_file_size(path_), list_days)) {
+                    return WRITE_ERROR;
+                }
+                for(auto it = log_days_.begin(); it != log_days_.end(); ++it) {
+                    nlohmann::json j;
+                    try {
+                        j = nlohmann::json::parse(it->second);
+                    }
+                    catch(...) {
+                        return PARSER_ERROR;
+                    }
+                    const int err = iStorage->write_json(j, it->first);
+                    if(err != xquotes_common::OK) return err;
+                }
+                iStorage->save();
+                /* проверим, что дни журнала видны в файле хранилища, прежде чем сбросить журнал */
+                if(!log_days_.empty()) {
+                    xquotes_json_storage::JsonStorage reader(path_);
+                    for(auto it = log_days_.begin(); it != log_days_.end(); ++it) {
+                        if(!reader.check_timestamp(it->first)) return WRITE_ERROR;
+                    }
+                }
+                day_index_.save(get_index_file_name(), get_file_size(path_));
+                if(!write_log_->reset()) return WRITE_ERROR;
+                log_days_.clear();
+                return OK;
+            }
+            iStorage->save();
+            is_storage_changed_ = false;
+            /* процессы, которые только читают хранилище, индекс не сохраняют */
+            if(is_write_) fill_day_index();
+            if(is_write_ && day_index_.is_modified()) {
+                if(day_index_.save(get_index_file_name(), get_file_size(path_))) {
+                    index_changed_days_.clear();
+                }
+            }
+            return OK;
+        }
+
+        /** \brief Включить журнал записи
+         *
+         * Журнал позволяет одному процессу-писателю обновлять хранилище,
+         * пока другие процессы читают его. Писатель дописывает новые дни в журнал (файл .wal рядом с хранилищем)
+         * и переносит их в хранилище только при вызове save(), под исключительной блокировкой.
+         * Читатели читают файл хранилища под разделяемой блокировкой и подхватывают новые дни из журнала
+         * методом update() без повторного открытия хранилища.
+         * \param is_writer Флаг процесса-писателя. В хранилище с журналом может писать только один процесс
+         * \return Вернет 0 в случае успеха или NO_DATA_ACCESS, если не удалось открыть файл блокировки
+         */
+        int set_write_log(const bool is_writer) {
+            std::unique_ptr<FileLock> store_lock(new FileLock(path_ + ".lock"));
+            if(!store_lock->is_open()) return NO_DATA_ACCESS;
+            store_lock_.swap(store_lock);
+            write_log_.reset(new WriteLog(path_ + ".wal"));
+            is_log_writer_ = is_writer;
+            update();
+            if(!is_writer) return OK;
+            /* писатель дополняет индекс дней и сразу переносит в хранилище то, что осталось в журнале от прошлого запуска */
+            fill_day_index();
+            return save();
+        }
+
+        /** \brief Подхватить новые дни из журнала записи
+         *
+         * Метод читает только новые записи в конце журнала. Если писатель успел перенести журнал в хранилище,
+         * файл хранилища будет открыт заново.
+         * \return Количество новых дней. Если не удалось захватить блокировку, журнал не читается
+         */
+        size_t update() {
+            if(!write_log_) return 0;
+            std::vector<std::pair<xtime::timestamp_t, std::string>> records;
+            bool is_new_generation = false;
+            {
+                FileLockGuard guard(*store_lock_, false);
+                if(!guard.is_lock()) return 0;
+                write_log_->read([&](const xtime::timestamp_t timestamp, const std::string &data) {
+                    records.push_back(std::make_pair(timestamp, data));
+                }, is_new_generation);
+                if(is_new_generation) {
+                    log_days_.clear();
+                    if(!is_log_writer_) reopen_storage();
+                }
+            }
+            for(size_t i = 0; i < records.size(); ++i) {
+                const xtime::timestamp_t day_timestamp = records[i].first;
+                day_index_.set_day(day_timestamp);
+                day_index_.set_hash(day_timestamp, get_hash(records[i].second));
+                day_index_.remove_summary(day_timestamp);
+                log_days_[day_timestamp].swap(records[i].second);
+                mark_day_changed(day_timestamp);
+                /* если день попал в загруженную область, область будет загружена заново */
+                if(day_timestamp >= timestamp_beg && day_timestamp <= timestamp_end) {
+                    timestamp_beg = timestamp_end = 0;
+                    hist.clear();
+                }
+            }
+            return records.size();
+        }
+
+        /** \brief Записать новости за один торговый день
+         *
+         * Если содержимое дня совпадает с уже записанным (по хешу), запись не выполняется.
+         * \param list_news Список новостей
+         * \param timestamp Метка времени
+         * \return Вернет 0 в случае успеха
+         */
+        int write_news(const std::vector<News> &list_news, const xtime::timestamp_t timestamp) {
+            nlohmann::json j;
+            encode_news(list_news, j);
+            const xtime::timestamp_t day_timestamp = xtime::get_first_timestamp_day(timestamp);
+            const std::string data = j.dump();
+            const uint64_t hash = get_hash(data);
+            if(is_same_day(day_timestamp, hash)) return OK;
+            return write_day_json(j, data, day_timestamp, hash);
+        }
+
+        /** \brief Записать новости за один торговый день и получить список изменений
+         *
+         * Если содержимое дня совпадает с уже записанным (по хешу), запись не выполняется и списки изменений будут пустыми.
+         * Новости сопоставляются по метке времени, имени и валюте.
+         * \param list_news Список новостей
+         * \param timestamp Метка времени
+         * \param changed_news Новости, которые появились или изменились
+         * \param removed_news Новости, которые были удалены
+         * \return Вернет 0 в случае успеха
+         */
+        int write_news(
+                const std::vector<News> &list_news,
+                const xtime::timestamp_t timestamp,
+                std::vector<News> &changed_news,
+                std::vector<News> &removed_news) {
+            changed_news.clear();
+            removed_news.clear();
+            nlohmann::json j;
+            encode_news(list_news, j);
+            const xtime::timestamp_t day_timestamp = xtime::get_first_timestamp_day(timestamp);
+            const std::string data = j.dump();
+            const uint64_t hash = get_hash(data);
+            if(is_same_day(day_timestamp, hash)) return OK;
+            std::vector<News> old_list_news;
+            if(day_index_.check_timestamp(day_timestamp)) read_news(old_list_news, day_timestamp);
+            int err = write_day_json(j, data, day_timestamp, hash);
+            if(err != OK) return err;
+            compare_news(old_list_news, list_news, changed_news, removed_news);
+            return OK;
+        }
+
+        /** \brief Получить хеш содержимого дня
+         *
+         * Хеш меняется только при изменении новостей дня,
+         * что позволяет зависимым данным обновляться лишь для изменившихся дней.
+         * \param timestamp Метка времени дня
+         * \param hash Хеш содержимого дня
+         * \return Вернет 0 в случае успеха
+         */
+        int get_day_hash(const xtime::timestamp_t timestamp, uint64_t &hash) {
+            const xtime::timestamp_t day_timestamp = xtime::get_first_timestamp_day(timestamp);
+            if(!day_index_.check_timestamp(day_timestamp)) return NO_DATA_ACCESS;
+            if(day_index_.get_hash(day_timestamp, hash)) return OK;
+            nlohmann::json j;
+            try {
+                int err = get_day_json(j, day_timestamp);
+                if(err != xquotes_common::OK) return err;
+                hash = get_hash(j.dump());
+            }
+            catch(...) {
+                return PARSER_ERROR;
+            }
+            day_index_.set_hash(day_timestamp, hash);
+            return OK;
+        }
+
+        /** \brief Установить количество потоков чтения дней
+         *
+         * Окна новостей из многих дней (get, filter) и построение индексов по всему хранилищу
+         * читают дни в нескольких потоках, что снижает время загрузки с диска, у которого велика задержка чтения.
+         * \param num_threads Количество потоков. Если 0, используется количество ядер процессора
+         */
+        void set_read_threads(const uint32_t num_threads) {
+            read_threads_ = num_threads;
+        }
+
+        /** \brief Получить сводку новостей дня
+         *
+         * Сводка берется из индекса дней. Если ее там еще нет, день читается из хранилища,
+         * а сводка запоминается в индексе в памяти.
+         * \param timestamp Метка времени дня
+         * \param summary Сводка новостей дня
+         * \return Вернет 0 в случае успеха
+         */
+        int get_day_summary(const xtime::timestamp_t timestamp, DaySummary &summary) {
+            const DaySummary *day_summary = find_day_summary(xtime::get_first_timestamp_day(timestamp));
+            if(day_summary == NULL) return NO_DATA_ACCESS;
+            summary = *day_summary;
+            return OK;
+        }
+
+        /** \brief Получить сводку новостей за период
+         *
+         * Период задается целыми днями: учитываются все новости дней от beg_timestamp до end_timestamp включительно.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param summary Сводка новостей периода
+         * \return Вернет 0 в случае успеха или NO_DATA_ACCESS, если за период нет новостей
+         */
+        int get_summary(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                DaySummary &summary) {
+            summary.clear();
+            if(beg_timestamp > end_timestamp) return INVALID_PARAMETER;
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
+            const xtime::timestamp_t start_timestamp = std::max(xtime::get_first_timestamp_day(beg_timestamp), min_timestamp);
+            const xtime::timestamp_t stop_timestamp = std::min(xtime::get_first_timestamp_day(end_timestamp), max_timestamp);
+            bool is_found = false;
+            for(xtime::timestamp_t t = start_timestamp; t <= stop_timestamp; t += xtime::SECONDS_IN_DAY) {
+                const DaySummary *day_summary = find_day_summary(t);
+                if(day_summary == NULL) continue;
+                summary.merge(*day_summary);
+                is_found = true;
+            }
+            return is_found ? OK : NO_DATA_ACCESS;
+        }
+
+        /** \brief Посчитать количество новостей за период
+         *
+         * Количество считается по сводкам дней, новости дней не декодируются.
+         * Период задается целыми днями, как в get_summary.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости
+         * \param count Количество новостей
+         * \return Вернет 0 в случае успеха
+         */
+        int count_news(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                uint64_t &count) {
+            count = 0;
+            if(beg_timestamp > end_timestamp) return INVALID_PARAMETER;
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
+            const xtime::timestamp_t start_timestamp = std::max(xtime::get_first_timestamp_day(beg_timestamp), min_timestamp);
+            const xtime::timestamp_t stop_timestamp = std::min(xtime::get_first_timestamp_day(end_timestamp), max_timestamp);
+            for(xtime::timestamp_t t = start_timestamp; t <= stop_timestamp; t += xtime::SECONDS_IN_DAY) {
+                const DaySummary *day_summary = find_day_summary(t);
+                if(day_summary == NULL) continue;
+                count += day_summary->get_count(currencies, min_level_volatility);
+            }
+            return OK;
+        }
+
+        /** \brief Получить дни, в которые есть подходящие новости
+         *
+         * Дни определяются по сводкам дней, новости дней не декодируются.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости
+         * \param list_timestamp Метки времени начала дней, в которые есть подходящие новости
+         * \return Вернет 0 в случае успеха
+         */
+        int get_days_with_news(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                std::vector<xtime::timestamp_t> &list_timestamp) {
+            list_timestamp.clear();
+            if(beg_timestamp > end_timestamp) return INVALID_PARAMETER;
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
+            const xtime::timestamp_t start_timestamp = std::max(xtime::get_first_timestamp_day(beg_timestamp), min_timestamp);
+            const xtime::timestamp_t stop_timestamp = std::min(xtime::get_first_timestamp_day(end_timestamp), max_timestamp);
+            for(xtime::timestamp_t t = start_timestamp; t <= stop_timestamp; t += xtime::SECONDS_IN_DAY) {
+                const DaySummary *day_summary = find_day_summary(t);
+                if(day_summary == NULL) continue;
+                if(day_summary->get_count(currencies, min_level_volatility) > 0) list_timestamp.push_back(t);
+            }
+            return OK;
+        }
+
+        /** \brief Параллельно обработать новости за период
+         *
+         * Дни периода раздаются потокам блоками. Каждый поток открывает хранилище для чтения отдельно
+         * и накапливает свой частичный результат, после чего частичные результаты объединяются в result.
+         * Порядок обработки дней не определен, поэтому функция объединения должна давать
+         * одинаковый результат при любом порядке частичных результатов.
+         * Перед началом данные из буфера хранилища записываются в файл.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param map_function Функция получит частичный результат потока, метку времени дня и новости дня
+         * \param reduce_function Функция добавит частичный результат к общему
+         * \param result Общий результат
+         * \param num_threads Количество потоков. Если 0, будет использовано количество ядер процессора
+         * \return Вернет 0 в случае успеха, PARSER_ERROR если часть дней не удалось прочитать
+         */
+        template<class T>
+        int map_reduce(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                std::function<void(
+                    T &partial,
+                    const xtime::timestamp_t timestamp,
+                    const std::vector<News> &list_news)> map_function,
+                std::function<void(T &result, const T &partial)> reduce_function,
+                T &result,
+                uint32_t num_threads = 0) {
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
+            std::vector<xtime::timestamp_t> list_days;
+            for(xtime::timestamp_t t = std::max(xtime::get_first_timestamp_day(beg_timestamp), min_timestamp);
+                t <= std::min(end_timestamp, max_timestamp);
+                t += xtime::SECONDS_IN_DAY) {
+                if(day_index_.check_timestamp(t)) list_days.push_back(t);
+            }
+            if(list_days.size() == 0) return NO_DATA_ACCESS;
+
+            if(num_threads == 0) num_threads = std::max(1U, std::thread::hardware_concurrency());
+            if(num_threads > list_days.size()) num_threads = (uint32_t)list_days.size();
+
+            const size_t BLOCK_SIZE = 16;
+            std::vector<T> partials(num_threads);
+            std::vector<int> list_err(num_threads, OK);
+            const int read_err = read_days_parallel(list_days, num_threads, BLOCK_SIZE,
+                    [&](const uint32_t n, const size_t i, const int day_err, const std::vector<News> &list_news) {
+                if(day_err != OK) {
+                    list_err[n] = PARSER_ERROR;
+                    return;
+                }
+                map_function(partials[n], list_days[i], list_news);
+            });
+            if(read_err != OK) return read_err;
+            int err = OK;
+            for(uint32_t n = 0; n < num_threads; ++n) {
+                reduce_function(result, partials[n]);
+                if(list_err[n] != OK) err = list_err[n];
+            }
+            return err;
         }
 
-        /** \brief Установить отступ данных от дня загрузки
+        /** \brief Посчитать статистику новостей за период
          *
-         * Отсутп позволяет загрузить используемую область данных заранее.
-         * Это позволит получать данные в пределах области без повторной загрузки подфайлов.
-         * При этом, цесли данные выйдут за пределы области, то область сместится, произойдет подзагрузка
-         * недостающих данных.
-         * \param indent_timestamp_past Отступ от даты загрузки в днях к началу исторических данных
-         * \param indent_timestamp_future Отступ от даты загрузки в днях к концу исторических данных
+         * Статистика считается параллельно методом map_reduce.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param statistics Статистика новостей
+         * \param num_threads Количество потоков. Если 0, будет использовано количество ядер процессора
+         * \return Вернет 0 в случае успеха
          */
-        void set_indent(
-                const uint32_t indent_timestamp_past,
-                const uint32_t indent_timestamp_future) {
-            iStorage.set_indent(indent_timestamp_past, indent_timestamp_future);
+        int get_statistics(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                NewsStatistics &statistics,
+                const uint32_t num_threads = 0) {
+            statistics = NewsStatistics();
+            return map_reduce<NewsStatistics>(
+                beg_timestamp,
+                end_timestamp,
+                [](NewsStatistics &partial, const xtime::timestamp_t timestamp, const std::vector<News> &list_news) {
+                    partial.add(timestamp, list_news);
+                },
+                [](NewsStatistics &result, const NewsStatistics &partial) {
+                    result.merge(partial);
+                },
+                statistics,
+                num_threads);
         }
 
-        /** \brief Сохранить данные
+        /** \brief Импортировать базу данных новостей в старом формате
          *
-         * Метод  принудительно сохраняет все данные, которые еще не записаны в файл а находятся только в буфере.
+         * Старый формат (ForexprostoolsApiEasy::DataBase) хранит новости каждого дня в отдельном файле ГОД_МЕСЯЦ_ДЕНЬ.json.
+         * Файлы разбираются параллельно несколькими потоками, а записываются в хранилище в порядке возрастания даты.
+         * Файлы, которые не удалось прочитать, пропускаются.
+         * \param path Директория с файлами старой базы данных
+         * \param num_threads Количество потоков для разбора файлов. Если 0, будет использовано количество ядер процессора
+         * \param user_function Функция для отображения прогресса, получает метку времени дня, номер файла и количество файлов
+         * \return Вернет 0 в случае успеха, PARSER_ERROR если часть файлов не удалось прочитать, или код ошибки записи
          */
-        void save() {
-            iStorage.save();
+        int import_legacy_news(
+                const std::string &path,
+                uint32_t num_threads = 0,
+                std::function<void(
+                    const xtime::timestamp_t timestamp,
+                    const size_t index,
+                    const size_t size)> user_function = nullptr) {
+            /* составляем список файлов в порядке возрастания даты */
+            std::vector<std::string> file_list;
+            bf::get_list_files(path, file_list, true);
+            std::vector<std::pair<xtime::timestamp_t, std::string>> list_days;
+            for(size_t i = 0; i < file_list.size(); ++i) {
+                xtime::timestamp_t t = 0;
+                if(file_list[i].find(".json") == std::string::npos) continue;
+                if(!get_date_from_file_name(file_list[i], t)) continue;
+                list_days.push_back(std::make_pair(t, file_list[i]));
+            }
+            if(list_days.size() == 0) return NO_DATA_ACCESS;
+            std::sort(list_days.begin(), list_days.end());
+
+            if(num_threads == 0) num_threads = std::max(1U, std::thread::hardware_concurrency());
+            /* максимальное количество разобранных, но еще не записанных дней */
+            const size_t MAX_WINDOW = 256 * num_threads;
+            std::vector<std::vector<News>> list_news(list_days.size());
+            std::vector<int> list_err(list_days.size(), OK);
+            std::vector<uint8_t> list_ready(list_days.size(), 0);
+            size_t next_index = 0;
+            size_t write_index = 0;
+            std::mutex mutex;
+            std::condition_variable cv;
+
+            std::vector<std::thread> workers;
+            for(uint32_t n = 0; n < num_threads; ++n) {
+                workers.push_back(std::thread([&]() {
+                    while(true) {
+                        size_t index = 0;
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            cv.wait(lock, [&]{
+                                return next_index >= list_days.size() ||
+                                    next_index < write_index + MAX_WINDOW;
+                            });
+                            if(next_index >= list_days.size()) return;
+                            index = next_index++;
+                        }
+                        std::vector<News> day_news;
+                        int err = read_news_file(list_days[index].second, day_news);
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            list_news[index].swap(day_news);
+                            list_err[index] = err;
+                            list_ready[index] = 1;
+                        }
+                        cv.notify_all();
+                    }
+                }));
+            }
+
+            /* записываем дни строго по порядку по мере готовности */
+            int err_import = OK;
+            for(size_t i = 0; i < list_days.size(); ++i) {
+                std::vector<News> day_news;
+                int err = OK;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]{ return list_ready[i] != 0; });
+                    day_news.swap(list_news[i]);
+                    err = list_err[i];
+                    write_index = i + 1;
+                }
+                cv.notify_all();
+                if(err != OK) {
+                    err_import = PARSER_ERROR;
+                } else {
+                    err = write_news(day_news, list_days[i].first);
+                    if(err != OK) err_import = err;
+                }
+                if(user_function != nullptr) user_function(list_days[i].first, i, list_days.size());
+            }
+            for(size_t n = 0; n < workers.size(); ++n) {
+                workers[n].join();
+            }
+            save();
+            return err_import;
         }
 
-        /** \brief Записать новости за один торговый день
-         * \param list_news Список новостей
-         * \param timestamp Метка времени
-         * \return Вернет 0 в случае успеха
+        /** \brief Прочитать новости нескольких дней
+         *
+         * Если задано несколько потоков чтения (set_read_threads), дни читаются параллельно.
+         * \param list_days Метки времени начала дней
+         * \param days_news Новости каждого дня
+         * \param list_err Коды ошибок чтения каждого дня (0 в случае успеха)
          */
-        int write_news(const std::vector<News> &list_news, const xtime::timestamp_t timestamp) {
-            nlohmann::json j;
-            for(size_t i = 0; i < list_news.size(); ++i) {
-                j[i]["name"] = list_news[i].name;
-                j[i]["currency"] = list_news[i].currency;
-                j[i]["country"] = list_news[i].country;
-                j[i]["volatility"] = list_news[i].level_volatility;
-                j[i]["timestamp"] = list_news[i].timestamp;
-                if(list_news[i].is_previous) j[i]["previous"] = list_news[i].previous;
-                if(list_news[i].is_actual) j[i]["actual"] = list_news[i].actual;
-                if(list_news[i].is_forecast) j[i]["forecast"] = list_news[i].forecast;
-            }
-            return iStorage.write_json(j, xtime::get_first_timestamp_day(timestamp));
+        void read_news(
+                const std::vector<xtime::timestamp_t> &list_days,
+                std::vector<std::vector<News>> &days_news,
+                std::vector<int> &list_err) {
+            read_days(list_days, days_news, list_err);
         }
 
         /** \brief Прочитать новости за торговый день
@@ -136,45 +1242,21 @@ namespace ForexprostoolsDataStore {
          * \return Вернет 0 в случае успеха
          */
         int read_news(std::vector<News> &list_news, const xtime::timestamp_t timestamp) {
-            list_news.clear();
             nlohmann::json j;
             try {
-                int err = iStorage.get_json(j, xtime::get_first_timestamp_day(timestamp));
-                if(err != xquotes_common::OK) return err;
+                int err = get_day_json(j, xtime::get_first_timestamp_day(timestamp));
+                if(err != xquotes_common::OK) {
+                    list_news.clear();
+                    return err;
+                }
+                /* элементы массива не удаляются, чтобы строки могли повторно использовать свою память */
                 list_news.resize(j.size());
                 for(size_t i = 0; i < list_news.size(); ++i) {
-                    list_news[i].name = j[i]["name"];
-                    list_news[i].currency = j[i]["currency"];
-                    list_news[i].country = j[i]["country"];
-                    list_news[i].level_volatility = j[i]["volatility"];
-                    list_news[i].timestamp = j[i]["timestamp"];
-                    auto it_previous = j[i].find("previous");
-                    auto it_actual = j[i].find("actual");
-                    auto it_forecast = j[i].find("forecast");
-                    if(it_previous != j[i].end()) {
-                        list_news[i].previous = *it_previous;
-                        list_news[i].is_previous = true;
-                    } else {
-                        list_news[i].previous = 0;
-                        list_news[i].is_previous = false;
-                    }
-                    if(it_actual != j[i].end()) {
-                        list_news[i].actual = *it_actual;
-                        list_news[i].is_actual = true;
-                    } else {
-                        list_news[i].actual = 0;
-                        list_news[i].is_actual = true;
-                    }
-                    if(it_forecast != j[i].end()) {
-                        list_news[i].forecast = *it_forecast;
-                        list_news[i].is_forecast = true;
-                    } else {
-                        list_news[i].forecast = 0;
-                        list_news[i].is_forecast = true;
-                    }
+                    decode_news(j[i], list_news[i]);
                 }
             }
             catch(...) {
+                list_news.clear();
                 return PARSER_ERROR;
             }
             return OK;
@@ -193,30 +1275,45 @@ namespace ForexprostoolsDataStore {
                 const xtime::timestamp_t indent_timestamp_past,
                 const xtime::timestamp_t indent_timestamp_future,
                 std::vector<News> &news_data) {
+            load_window(timestamp, indent_timestamp_past, indent_timestamp_future);
+            /* хочется тут написать что то типа return NO_DATA_ACCESS ?
+             * НЕЕТ! НЕ НАДО ТУТ ЭТО ПИСАТЬ! ДАННЫЕ УЖЕ МОГУТ СОДЕРЖАТЬСЯ В hist!!!
+             */
+            return hist.get_news(timestamp, indent_timestamp_past, indent_timestamp_future, news_data);
+        }
+
+        /** \brief Загрузить в hist дни, которые покрывают окно новостей
+         * \param timestamp Метка времени
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         */
+        void load_window(
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future) {
             const xtime::timestamp_t start_timestamp = xtime::get_first_timestamp_day(timestamp - indent_timestamp_past);
             const xtime::timestamp_t stop_timestamp = xtime::get_first_timestamp_day(timestamp + indent_timestamp_future);
 
             /* проверяем доступность данных */
             if(start_timestamp < timestamp_beg || stop_timestamp > timestamp_end) {
                 hist.clear();
+                buffer_days_.clear();
                 for(xtime::timestamp_t t = start_timestamp; t <= stop_timestamp; t += xtime::SECONDS_IN_DAY) {
-                    std::vector<News> list_news;
-                    int err = read_news(list_news, t);
-                    if(err == OK) hist.add_news(list_news);
+                    if(day_index_.check_timestamp(t)) buffer_days_.push_back(t);
+                }
+                read_days(buffer_days_, buffer_days_news_, buffer_days_err_);
+                for(size_t i = 0; i < buffer_days_.size(); ++i) {
+                    if(buffer_days_err_[i] == OK) hist.add_news(buffer_days_news_[i]);
                 }
                 timestamp_beg = start_timestamp;
                 timestamp_end = stop_timestamp;
             }
-            /* хочется тут написать что то типа return NO_DATA_ACCESS ?
-             * НЕЕТ! НЕ НАДО ТУТ ЭТО ПИСАТЬ! ДАННЫЕ УЖЕ МОГУТ СОДЕРЖАТЬСЯ В hist!!!
-             */
-            return hist.get_news(timestamp, indent_timestamp_past, indent_timestamp_future, news_data);
         }
 
         /** \brief Фильтр новостей
          *
          * Данный метод поместит в state NEWS_FOUND, если есть новости, или NO_NEWS, если новостей нет
-         * \param pair_name имя валютной пары
+         * \param pair Валютная пара
          * \param timestamp Текущее время (Метка времени)
          * \param indent_timestamp_past Максимальный отступ до метки времени
          * \param indent_timestamp_future Максимальный отступ после метки времени
@@ -225,24 +1322,25 @@ namespace ForexprostoolsDataStore {
          * \return вернет 0 в случае успеха
          */
         int filter(
-                const std::string &pair_name,
+                const CurrencyPair &pair,
                 const xtime::timestamp_t timestamp,
                 const xtime::timestamp_t indent_timestamp_past,
                 const xtime::timestamp_t indent_timestamp_future,
                 const int min_level_volatility,
                 int &state) {
             state = NO_NEWS;
-            std::string currency_1, currency_2;
-            int err = get_currencies(pair_name, currency_1, currency_2);
-            if(err != OK) return err;
+            if(!pair.is_valid()) return INVALID_PARAMETER;
 
-            std::vector<News> news_data;
-            err = get(timestamp, indent_timestamp_past, indent_timestamp_future, news_data);
+            /* новости окна не копируются, проверяются только столбцы уровней силы и валют */
+            load_window(timestamp, indent_timestamp_past, indent_timestamp_future);
+            size_t beg_index = 0, end_index = 0;
+            int err = hist.get_range(timestamp, indent_timestamp_past, indent_timestamp_future, beg_index, end_index);
             if(err != OK) return err;
 
-            for(size_t i = 0; i < news_data.size(); ++i) {
-                if((news_data[i].currency == currency_1 || news_data[i].currency == currency_2) &&
-                (news_data[i].level_volatility >= min_level_volatility)) {
+            const std::vector<int8_t> &levels = hist.get_levels();
+            for(size_t i = beg_index; i < end_index; ++i) {
+                if(levels[i] >= min_level_volatility &&
+                    pair.check(hist.get_currency_code(i))) {
                     state = NEWS_FOUND;
                     return OK;
                 }
@@ -257,6 +1355,33 @@ namespace ForexprostoolsDataStore {
          * \param timestamp Текущее время (Метка времени)
          * \param indent_timestamp_past Максимальный отступ до метки времени
          * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param state состояние фильтра (NEWS_FOUND или NO_NEWS)
+         * \return вернет 0 в случае успеха
+         */
+        int filter(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const int min_level_volatility,
+                int &state) {
+            return filter(
+                CurrencyPair(pair_name),
+                timestamp,
+                indent_timestamp_past,
+                indent_timestamp_future,
+                min_level_volatility,
+                state);
+        }
+
+        /** \brief Фильтр новостей
+         *
+         * Данный метод поместит в state NEWS_FOUND, если есть новости, или NO_NEWS, если новостей нет
+         * \param pair Валютная пара
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
          * \param is_only_select Использовать только выбранные уровни силы новости.
          * Если есть новость с другим уровнем силы, функция поместит в state NEWS_FOUND.
          * \param is_low Использовать слабые новости.
@@ -266,7 +1391,7 @@ namespace ForexprostoolsDataStore {
          * \return вернет 0 в случае успеха
          */
         int filter(
-                const std::string &pair_name,
+                const CurrencyPair &pair,
                 const xtime::timestamp_t timestamp,
                 const xtime::timestamp_t indent_timestamp_past,
                 const xtime::timestamp_t indent_timestamp_future,
@@ -276,45 +1401,137 @@ namespace ForexprostoolsDataStore {
                 const bool is_high,
                 int &state) {
             state = NO_NEWS;
-            std::string currency_1, currency_2;
-            int err = get_currencies(pair_name, currency_1, currency_2);
+            if(!pair.is_valid()) return INVALID_PARAMETER;
+
+            load_window(timestamp, indent_timestamp_past, indent_timestamp_future);
+            size_t beg_index = 0, end_index = 0;
+            int err = hist.get_range(timestamp, indent_timestamp_past, indent_timestamp_future, beg_index, end_index);
             if(err != OK) return err;
+            state = hist.get_filter_state(pair, beg_index, end_index, is_only_select, is_low, is_moderate, is_high);
+            return OK;
+        }
+
+        /** \brief Фильтр новостей для нескольких валютных пар
+         *
+         * Окно новостей загружается один раз. Валюте каждой новости соответствует бит в маске,
+         * маски новостей объединяются по уровням силы за один проход (с AVX2, если он доступен),
+         * после чего состояние каждой пары получается проверкой двух масок.
+         * Результат для каждой пары совпадает с методом filter для одной пары.
+         * \param pairs Валютные пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param is_only_select Использовать только выбранные уровни силы новости.
+         * \param is_low Использовать слабые новости.
+         * \param is_moderate Использовать новости средней силы.
+         * \param is_high Использовать сильные новости.
+         * \param states Состояния фильтра для каждой валютной пары (NEWS_FOUND или NO_NEWS)
+         * \return вернет 0 в случае успеха
+         */
+        int filter(
+                const std::vector<CurrencyPair> &pairs,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high,
+                std::vector<int> &states) {
+            states.assign(pairs.size(), NO_NEWS);
+            /* валюты пар регистрируются первыми, поэтому новость с валютой пары всегда получит бит */
+            pair_masks_.resize(pairs.size());
+            for(size_t i = 0; i < pairs.size(); ++i) {
+                if(!pairs[i].is_valid()) return INVALID_PARAMETER;
+                const uint64_t base = currency_registry_.add(pairs[i].get_base());
+                const uint64_t quote = currency_registry_.add(pairs[i].get_quote());
+                pair_masks_[i] = (base != 0 && quote != 0) ? (base | quote) : 0;
+            }
 
-            std::vector<News> news_data;
-            err = get(timestamp, indent_timestamp_past, indent_timestamp_future, news_data);
+            load_window(timestamp, indent_timestamp_past, indent_timestamp_future);
+            size_t beg_index = 0, end_index = 0;
+            int err = hist.get_range(timestamp, indent_timestamp_past, indent_timestamp_future, beg_index, end_index);
             if(err != OK) return err;
-            for(size_t i = 0; i < news_data.size(); ++i) {
-                if(news_data[i].currency != currency_1 &&
-                    news_data[i].currency != currency_2) continue;
-                if(news_data[i].level_volatility == ForexprostoolsApiEasy::LOW) {
-                    if(is_low) state = NEWS_FOUND;
-                    else if(is_only_select) {
-                        state = NO_NEWS;
-                        return OK;
-                    }
-                } else
-                if(news_data[i].level_volatility == ForexprostoolsApiEasy::MODERATE) {
-                    if(is_moderate) state = NEWS_FOUND;
-                    else if(is_only_select) {
-                        state = NO_NEWS;
-                        return OK;
-                    }
-                } else
-                if(news_data[i].level_volatility == ForexprostoolsApiEasy::HIGH) {
-                    if(is_high) state = NEWS_FOUND;
-                    else if(is_only_select) {
-                        state = NO_NEWS;
-                        return OK;
-                    }
+
+            /* маска ищется в реестре один раз для каждой валюты таблицы валют, а не для каждой новости */
+            const std::vector<uint32_t> &currency_codes = hist.get_currency_codes();
+            currency_id_masks_.resize(currency_codes.size());
+            for(size_t id = 0; id < currency_codes.size(); ++id) {
+                currency_id_masks_[id] = currency_registry_.get(CurrencyCode(currency_codes[id]));
+            }
+
+            const size_t num_news = end_index - beg_index;
+            const std::vector<int8_t> &levels = hist.get_levels();
+            const std::vector<uint32_t> &currency_ids = hist.get_currency_ids();
+            column_masks_.resize(num_news);
+            column_levels_.resize(num_news);
+            for(size_t i = 0; i < num_news; ++i) {
+                column_masks_[i] = currency_id_masks_[currency_ids[beg_index + i]];
+                column_levels_[i] = levels[beg_index + i];
+            }
+            uint64_t level_masks[HIGH + 1];
+            get_level_masks(column_masks_.data(), column_levels_.data(), num_news, level_masks);
+
+            const bool is_select[HIGH + 1] = {is_low, is_moderate, is_high};
+            uint64_t select_mask = 0, other_mask = 0;
+            for(int level = LOW; level <= HIGH; ++level) {
+                if(is_select[level]) select_mask |= level_masks[level];
+                else other_mask |= level_masks[level];
+            }
+            for(size_t i = 0; i < pairs.size(); ++i) {
+                if(pair_masks_[i] == 0) {
+                    /* для валюты не хватило бита, проверяем пару обычным способом */
+                    states[i] = hist.get_filter_state(pairs[i], beg_index, end_index, is_only_select, is_low, is_moderate, is_high);
+                    continue;
                 }
+                if(is_only_select && (other_mask & pair_masks_[i]) != 0) continue;
+                if((select_mask & pair_masks_[i]) != 0) states[i] = NEWS_FOUND;
             }
             return OK;
         }
 
+        /** \brief Фильтр новостей
+         *
+         * Данный метод поместит в state NEWS_FOUND, если есть новости, или NO_NEWS, если новостей нет
+         * \param pair_name имя валютной пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param is_only_select Использовать только выбранные уровни силы новости.
+         * Если есть новость с другим уровнем силы, функция поместит в state NEWS_FOUND.
+         * \param is_low Использовать слабые новости.
+         * \param is_moderate Использовать новости средней силы.
+         * \param is_high Использовать сильные новости.
+         * \param state состояние фильтра (NEWS_FOUND или NO_NEWS)
+         * \return вернет 0 в случае успеха
+         */
+        int filter(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high,
+                int &state) {
+            return filter(
+                CurrencyPair(pair_name),
+                timestamp,
+                indent_timestamp_past,
+                indent_timestamp_future,
+                is_only_select,
+                is_low,
+                is_moderate,
+                is_high,
+                state);
+        }
+
         /** \brief Проверить новости
          *
          * Данный метод вернет true если есть новости или новость по указанным параметрам.
-         * \param pair_name имя валютной пары
+         * Валютную пару лучше разобрать один раз и передавать в этот метод в цикле.
+         * \param pair Валютная пара
          * \param timestamp Текущее время (Метка времени)
          * \param indent_timestamp_past Максимальный отступ до метки времени
          * \param indent_timestamp_future Максимальный отступ после метки времени
@@ -326,7 +1543,7 @@ namespace ForexprostoolsDataStore {
          * \return вернет true если есть новость, подходящая по указанным параметрам
          */
         bool is_news(
-                const std::string &pair_name,
+                const CurrencyPair &pair,
                 const xtime::timestamp_t timestamp,
                 const xtime::timestamp_t indent_timestamp_past,
                 const xtime::timestamp_t indent_timestamp_future,
@@ -336,7 +1553,7 @@ namespace ForexprostoolsDataStore {
                 const bool is_high) {
             int state = NO_NEWS;
             int err = filter(
-                pair_name,
+                pair,
                 timestamp,
                 indent_timestamp_past,
                 indent_timestamp_future,
@@ -348,6 +1565,40 @@ namespace ForexprostoolsDataStore {
             return (err == OK && state == NEWS_FOUND);
         }
 
+        /** \brief Проверить новости
+         *
+         * Данный метод вернет true если есть новости или новость по указанным параметрам.
+         * \param pair_name имя валютной пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param is_only_select Использовать только выбранные уровни силы новости.
+         * Если есть новость с другим уровнем силы, функция поместит в state NEWS_FOUND.
+         * \param is_low Использовать слабые новости.
+         * \param is_moderate Использовать новости средней силы.
+         * \param is_high Использовать сильные новости.
+         * \return вернет true если есть новость, подходящая по указанным параметрам
+         */
+        bool is_news(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high) {
+            return is_news(
+                CurrencyPair(pair_name),
+                timestamp,
+                indent_timestamp_past,
+                indent_timestamp_future,
+                is_only_select,
+                is_low,
+                is_moderate,
+                is_high);
+        }
+
         /** \brief Получить массив новостей с конкретным именем и валютой
          * \param timestamp Метка времени
          * \param news_name Имя новости
@@ -365,10 +1616,13 @@ namespace ForexprostoolsDataStore {
                 const uint32_t number_news = 0,
                 const bool is_reverse = false) {
 
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(!day_index_.get_min_max_timestamp(min_timestamp, max_timestamp)) return NO_DATA_ACCESS;
             for(xtime::timestamp_t t = xtime::get_first_timestamp_day(timestamp);
-                t > 0;
+                t > 0 && t >= min_timestamp;
                 t -= xtime::SECONDS_IN_DAY) {
-                std::vector<News> list_news;
+                if(!day_index_.check_timestamp(t)) continue;
+                std::vector<News> &list_news = buffer_news_;
                 int err = read_news(list_news, t);
                 if(err != OK) continue;
                 for(size_t n = 0; n < list_news.size(); ++n) {
@@ -393,6 +1647,158 @@ namespace ForexprostoolsDataStore {
             }
             return NO_DATA_ACCESS;
         }
+
+        /** \brief Получить новости, подходящие под условие
+         *
+         * В отличие от get(), новости не копируются из загруженной области,
+         * а условие проверяется до декодирования, поэтому декодируются только нужные новости.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param predicate Условие отбора новостей
+         * \param news_data Список новостей в порядке возрастания времени
+         * \param number_news Максимальное количество новостей. Если 0, количество не ограничено
+         * \return Вернет 0 в случае успеха
+         */
+        int query(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const NewsPredicate &predicate,
+                std::vector<News> &news_data,
+                const size_t number_news = 0) {
+            news_data.clear();
+            return for_each_news(beg_timestamp, end_timestamp, predicate, [&](const nlohmann::json &item) -> bool {
+                news_data.resize(news_data.size() + 1);
+                decode_news(item, news_data.back());
+                return number_news == 0 || news_data.size() < number_news;
+            });
+        }
+
+        /** \brief Посчитать новости, подходящие под условие
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param predicate Условие отбора новостей
+         * \param number_news Количество новостей
+         * \return Вернет 0 в случае успеха
+         */
+        int count(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const NewsPredicate &predicate,
+                size_t &number_news) {
+            number_news = 0;
+            return for_each_news(beg_timestamp, end_timestamp, predicate, [&](const nlohmann::json &item) -> bool {
+                ++number_news;
+                return true;
+            });
+        }
+
+        /** \brief Проверить наличие новостей, подходящих под условие
+         *
+         * Перебор прекращается на первой подходящей новости.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param predicate Условие отбора новостей
+         * \return Вернет true, если есть хотя бы одна подходящая новость
+         */
+        bool any(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const NewsPredicate &predicate) {
+            bool is_found = false;
+            for_each_news(beg_timestamp, end_timestamp, predicate, [&](const nlohmann::json &item) -> bool {
+                is_found = true;
+                return false;
+            });
+            return is_found;
+        }
+
+        /** \brief Найти следующее событие
+         *
+         * При первом вызове строится индекс событий по всему хранилищу,
+         * затем поиск выполняется двоичным поиском и читает только день найденного события.
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param news Первая подходящая новость строго после timestamp
+         * \return Вернет 0 в случае успеха
+         */
+        int next_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            update_event_index();
+            xtime::timestamp_t event_timestamp = 0;
+            if(!event_index_.find_next(timestamp, currencies, min_level_volatility, event_timestamp)) return NO_DATA_ACCESS;
+            return get_event(event_timestamp, currencies, min_level_volatility, news);
+        }
+
+        /** \brief Найти предыдущее событие
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param news Последняя подходящая новость не позже timestamp
+         * \return Вернет 0 в случае успеха
+         */
+        int prev_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            update_event_index();
+            xtime::timestamp_t event_timestamp = 0;
+            if(!event_index_.find_prev(timestamp, currencies, min_level_volatility, event_timestamp)) return NO_DATA_ACCESS;
+            return get_event(event_timestamp, currencies, min_level_volatility, news);
+        }
+
+        /** \brief Получить производные показатели новости
+         *
+         * При первом вызове показатели считаются по всему хранилищу и кэшируются.
+         * После записи новых дней пересчитываются только затронутые ряды новостей.
+         * \param timestamp Метка времени новости
+         * \param news_name Имя новости
+         * \param currency Валюта новости
+         * \param metrics Показатели новости
+         * \return Вернет 0 в случае успеха
+         */
+        int get_surprise(
+                const xtime::timestamp_t timestamp,
+                const std::string &news_name,
+                const std::string &currency,
+                SurpriseMetrics &metrics) {
+            update_surprise_index();
+            if(!surprise_index_.get(timestamp, news_name, currency, metrics)) return NO_DATA_ACCESS;
+            return OK;
+        }
+
+        /** \brief Получить производные показатели новости
+         * \param news Новость
+         * \param metrics Показатели новости
+         * \return Вернет 0 в случае успеха
+         */
+        int get_surprise(const News &news, SurpriseMetrics &metrics) {
+            return get_surprise(news.timestamp, news.name, news.currency, metrics);
+        }
+
+        /** \brief Получить ряд производных показателей новости
+         * \param news_name Имя новости
+         * \param currency Валюта новости
+         * \param list_metrics Показатели всех новостей ряда в порядке возрастания времени
+         * \return Вернет 0 в случае успеха
+         */
+        int get_surprise_history(
+                const std::string &news_name,
+                const std::string &currency,
+                std::vector<SurpriseMetrics> &list_metrics) {
+            update_surprise_index();
+            const std::vector<SurpriseMetrics> *series = surprise_index_.get_series(news_name, currency);
+            if(series == nullptr) {
+                list_metrics.clear();
+                return NO_DATA_ACCESS;
+            }
+            list_metrics = *series;
+            return OK;
+        }
     };
 }
 #endif // FOREXPROSTOOLS_DATA_STOR_HPP_INCLUDED
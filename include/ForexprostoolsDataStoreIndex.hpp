@@ -0,0 +1,596 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_DATA_STORE_INDEX_HPP_INCLUDED
+#define FOREXPROSTOOLS_DATA_STORE_INDEX_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsDataStore {
+    using namespace ForexprostoolsApiEasy;
+
+    /** \brief Сводка новостей дня
+     *
+     * Сводка хранит количество новостей по валютам и уровням силы, метки времени первой
+     * и последней новости и количество новостей с каждым из значений.
+     * Сводки дней можно объединять методом merge, чтобы получить сводку за период.
+     */
+    class DaySummary {
+    public:
+        /// Количество новостей валюты по уровням силы
+        class CurrencyCount {
+        public:
+            uint32_t code = 0;                  /**< Упакованный код валюты (CurrencyCode), 0 для валют с неверным именем */
+            uint32_t counts[HIGH + 1] = {0};    /**< Количество новостей для уровней LOW, MODERATE и HIGH */
+
+            CurrencyCount() {};
+            CurrencyCount(const uint32_t currency_code) : code(currency_code) {};
+        };
+
+        std::vector<CurrencyCount> currencies;  /**< Количество новостей по валютам, отсортировано по коду валюты */
+        xtime::timestamp_t first_timestamp = 0; /**< Метка времени первой новости */
+        xtime::timestamp_t last_timestamp = 0;  /**< Метка времени последней новости */
+        uint32_t num_news = 0;                  /**< Количество новостей */
+        uint32_t num_previous = 0;              /**< Количество новостей с предыдущим значением */
+        uint32_t num_actual = 0;                /**< Количество новостей с актуальным значением */
+        uint32_t num_forecast = 0;              /**< Количество новостей с предсказанным значением */
+
+    private:
+
+        CurrencyCount &get_currency(const uint32_t code) {
+            auto it = std::lower_bound(currencies.begin(), currencies.end(), code,
+                [](const CurrencyCount &lhs, const uint32_t rhs) {return lhs.code < rhs;});
+            if(it != currencies.end() && it->code == code) return *it;
+            return *currencies.insert(it, CurrencyCount(code));
+        }
+
+    public:
+
+        DaySummary() {};
+
+        void clear() {
+            currencies.clear();
+            first_timestamp = last_timestamp = 0;
+            num_news = num_previous = num_actual = num_forecast = 0;
+        }
+
+        /** \brief Добавить новость в сводку
+         * \param currency Валюта новости
+         * \param level_volatility Уровень силы новости
+         * \param timestamp Метка времени новости
+         * \param is_previous Флаг наличия предыдущего значения
+         * \param is_actual Флаг наличия актуального значения
+         * \param is_forecast Флаг наличия предсказанного значения
+         */
+        void add(
+                const std::string &currency,
+                const int level_volatility,
+                const xtime::timestamp_t timestamp,
+                const bool is_previous,
+                const bool is_actual,
+                const bool is_forecast) {
+            if(num_news == 0 || timestamp < first_timestamp) first_timestamp = timestamp;
+            if(num_news == 0 || timestamp > last_timestamp) last_timestamp = timestamp;
+            ++num_news;
+            if(is_previous) ++num_previous;
+            if(is_actual) ++num_actual;
+            if(is_forecast) ++num_forecast;
+            CurrencyCount &count = get_currency(CurrencyCode::pack(currency));
+            if(level_volatility >= LOW && level_volatility <= HIGH) ++count.counts[level_volatility];
+        }
+
+        /** \brief Добавить новость в сводку
+         * \param news Новость
+         */
+        void add(const News &news) {
+            add(news.currency, news.level_volatility, news.timestamp, news.is_previous, news.is_actual, news.is_forecast);
+        }
+
+        /** \brief Объединить сводки
+         * \param other Сводка другого дня или периода
+         */
+        void merge(const DaySummary &other) {
+            if(other.num_news == 0) return;
+            if(num_news == 0 || other.first_timestamp < first_timestamp) first_timestamp = other.first_timestamp;
+            if(num_news == 0 || other.last_timestamp > last_timestamp) last_timestamp = other.last_timestamp;
+            num_news += other.num_news;
+            num_previous += other.num_previous;
+            num_actual += other.num_actual;
+            num_forecast += other.num_forecast;
+            for(size_t i = 0; i < other.currencies.size(); ++i) {
+                CurrencyCount &count = get_currency(other.currencies[i].code);
+                for(int level = LOW; level <= HIGH; ++level) count.counts[level] += other.currencies[i].counts[level];
+            }
+        }
+
+        /** \brief Получить количество новостей
+         * \param currencies_filter Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости
+         * \return Количество новостей с уровнем силы от LOW до HIGH
+         */
+        uint64_t get_count(
+                const std::vector<std::string> &currencies_filter,
+                const int min_level_volatility) const {
+            uint64_t count = 0;
+            for(size_t i = 0; i < currencies.size(); ++i) {
+                if(!currencies_filter.empty() && !check_currency(currencies[i].code, currencies_filter)) continue;
+                for(int level = std::max(min_level_volatility, (int)LOW); level <= HIGH; ++level) {
+                    count += currencies[i].counts[level];
+                }
+            }
+            return count;
+        }
+
+        /** \brief Проверить наличие кода валюты в списке валют
+         * \param code Упакованный код валюты
+         * \param currencies_filter Список валют
+         * \return Вернет true, если валюта есть в списке
+         */
+        static bool check_currency(const uint32_t code, const std::vector<std::string> &currencies_filter) {
+            for(size_t i = 0; i < currencies_filter.size(); ++i) {
+                if(CurrencyCode::pack(currencies_filter[i]) == code) return true;
+            }
+            return false;
+        }
+    };
+
+    /** \brief Индекс дней хранилища
+     *
+     * Индекс хранит битовую карту дней, за которые в хранилище есть новости,
+     * а также первый и последний день. Индекс сохраняется в отдельный файл рядом с хранилищем,
+     * поэтому проверка наличия дня и поиск минимальной и максимальной даты не требуют чтения хранилища.
+     * Для каждого дня также хранится хеш содержимого, что позволяет не перезаписывать неизменившиеся дни,
+     * и сводка новостей дня, по которой считаются количества новостей за период без чтения хранилища.
+     * Отдельная битовая карта хранит дни, для которых сервер подтвердил отсутствие новостей,
+     * чтобы повторная загрузка не запрашивала их снова.
+     */
+    class DayIndex {
+    private:
+        std::vector<uint8_t> days_;         /**< Битовая карта дней, номер бита равен номеру дня от начала эпохи */
+        std::vector<uint8_t> empty_days_;   /**< Битовая карта дней, для которых сервер подтвердил отсутствие новостей */
+        uint32_t min_day_ = 0;              /**< Первый день с данными */
+        uint32_t max_day_ = 0;              /**< Последний день с данными */
+        uint32_t num_days_ = 0;             /**< Количество дней с данными */
+        std::unordered_map<uint32_t, uint64_t> hashes_; /**< Хеши содержимого дней */
+        std::unordered_map<uint32_t, DaySummary> summaries_; /**< Сводки новостей дней */
+        bool is_modified_ = false;          /**< Флаг изменения индекса */
+
+        enum {
+            MAGIC = 0x49445046,             /**< Сигнатура файла индекса ("FPDI") */
+            VERSION = 4,                    /**< Версия формата файла индекса */
+        };
+
+        template<class T>
+        static bool read_value(std::ifstream &file, T &value) {
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return (bool)file;
+        }
+
+        template<class T>
+        static void write_value(std::ofstream &file, const T &value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        /** \brief Записать индекс в файл
+         * \param file_name Имя файла
+         * \param storage_size Размер файла хранилища на момент сохранения
+         * \param skip_days Дни, хеши и сводки которых не записываются, или NULL
+         * \return Вернет true в случае успеха
+         */
+        bool write_file(
+                const std::string &file_name,
+                const uint64_t storage_size,
+                const std::unordered_set<uint32_t> *skip_days = NULL) const {
+            auto is_skip = [&](const uint32_t day) {
+                return skip_days != NULL && skip_days->count(day) > 0;
+            };
+            uint64_t num_hashes = 0, num_summaries = 0;
+            for(auto it = hashes_.begin(); it != hashes_.end(); ++it) {
+                if(!is_skip(it->first)) ++num_hashes;
+            }
+            for(auto it = summaries_.begin(); it != summaries_.end(); ++it) {
+                if(!is_skip(it->first)) ++num_summaries;
+            }
+            std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+            if(!file) return false;
+            write_value(file, (uint32_t)MAGIC);
+            write_value(file, (uint32_t)VERSION);
+            write_value(file, storage_size);
+            write_value(file, (uint64_t)days_.size());
+            if(days_.size() > 0) file.write(reinterpret_cast<const char*>(days_.data()), days_.size());
+            write_value(file, (uint64_t)empty_days_.size());
+            if(empty_days_.size() > 0) file.write(reinterpret_cast<const char*>(empty_days_.data()), empty_days_.size());
+            write_value(file, num_hashes);
+            for(auto it = hashes_.begin(); it != hashes_.end(); ++it) {
+                if(is_skip(it->first)) continue;
+                write_value(file, it->first);
+                write_value(file, it->second);
+            }
+            write_value(file, num_summaries);
+            for(auto it = summaries_.begin(); it != summaries_.end(); ++it) {
+                if(is_skip(it->first)) continue;
+                const DaySummary &summary = it->second;
+                write_value(file, it->first);
+                write_value(file, (uint64_t)summary.first_timestamp);
+                write_value(file, (uint64_t)summary.last_timestamp);
+                write_value(file, summary.num_news);
+                write_value(file, summary.num_previous);
+                write_value(file, summary.num_actual);
+                write_value(file, summary.num_forecast);
+                write_value(file, (uint32_t)summary.currencies.size());
+                for(size_t n = 0; n < summary.currencies.size(); ++n) {
+                    write_value(file, summary.currencies[n].code);
+                    for(int level = LOW; level <= HIGH; ++level) write_value(file, summary.currencies[n].counts[level]);
+                }
+            }
+            file.flush();
+            return (bool)file;
+        }
+
+        inline static uint32_t get_day(const xtime::timestamp_t timestamp) {
+            return (uint32_t)(timestamp / xtime::SECONDS_IN_DAY);
+        }
+
+        inline static bool check_bit(const std::vector<uint8_t> &bitmap, const uint32_t day) {
+            const size_t byte_index = day / 8;
+            if(byte_index >= bitmap.size()) return false;
+            return (bitmap[byte_index] & (1 << (day % 8))) != 0;
+        }
+
+        inline bool check_day(const uint32_t day) const {
+            return check_bit(days_, day);
+        }
+
+        /** \brief Пересчитать первый и последний день
+         */
+        void update_min_max() {
+            num_days_ = 0;
+            min_day_ = 0;
+            max_day_ = 0;
+            for(size_t i = 0; i < days_.size(); ++i) {
+                if(days_[i] == 0) continue;
+                for(uint32_t b = 0; b < 8; ++b) {
+                    if((days_[i] & (1 << b)) == 0) continue;
+                    const uint32_t day = (uint32_t)(i * 8 + b);
+                    if(num_days_ == 0) min_day_ = day;
+                    max_day_ = day;
+                    ++num_days_;
+                }
+            }
+        }
+
+    public:
+
+        DayIndex() {};
+
+        /** \brief Очистить индекс
+         */
+        void clear() {
+            days_.clear();
+            empty_days_.clear();
+            hashes_.clear();
+            summaries_.clear();
+            min_day_ = max_day_ = num_days_ = 0;
+            is_modified_ = true;
+        }
+
+        /** \brief Очистить битовую карту дней с новостями
+         *
+         * Дни без новостей, хеши и сводки остаются. Нужно, чтобы построить карту дней заново
+         * по хранилищу, если индекс устарел (см. load).
+         */
+        void clear_days() {
+            days_.clear();
+            min_day_ = max_day_ = num_days_ = 0;
+            is_modified_ = true;
+        }
+
+        /** \brief Забыть хеши и сводки дней, которых нет в битовой карте дней
+         */
+        void remove_missing_days() {
+            for(auto it = hashes_.begin(); it != hashes_.end();) {
+                if(check_day(it->first)) ++it;
+                else it = hashes_.erase(it);
+            }
+            for(auto it = summaries_.begin(); it != summaries_.end();) {
+                if(check_day(it->first)) ++it;
+                else it = summaries_.erase(it);
+            }
+        }
+
+        /** \brief Отметить день, за который в хранилище есть новости
+         *
+         * Индекс помечается измененным даже для уже известного дня,
+         * так как перезапись дня меняет размер файла хранилища.
+         * \param timestamp Метка времени дня
+         */
+        void set_day(const xtime::timestamp_t timestamp) {
+            const uint32_t day = get_day(timestamp);
+            is_modified_ = true;
+            if(check_day(day)) return;
+            if(check_bit(empty_days_, day)) empty_days_[day / 8] &= ~(1 << (day % 8));
+            const size_t byte_index = day / 8;
+            if(byte_index >= days_.size()) days_.resize(byte_index + 1, 0);
+            days_[byte_index] |= (1 << (day % 8));
+            if(num_days_ == 0 || day < min_day_) min_day_ = day;
+            if(num_days_ == 0 || day > max_day_) max_day_ = day;
+            ++num_days_;
+        }
+
+        /** \brief Проверить наличие дня в хранилище
+         * \param timestamp Метка времени
+         * \return Вернет true, если за день есть новости
+         */
+        inline bool check_timestamp(const xtime::timestamp_t timestamp) const {
+            return check_day(get_day(timestamp));
+        }
+
+        /** \brief Отметить день, для которого сервер подтвердил отсутствие новостей
+         *
+         * Если за день уже есть новости, отметка не ставится. Отметка снимается, когда за день записываются новости.
+         * \param timestamp Метка времени дня
+         */
+        void set_empty_day(const xtime::timestamp_t timestamp) {
+            const uint32_t day = get_day(timestamp);
+            if(check_day(day) || check_bit(empty_days_, day)) return;
+            const size_t byte_index = day / 8;
+            if(byte_index >= empty_days_.size()) empty_days_.resize(byte_index + 1, 0);
+            empty_days_[byte_index] |= (1 << (day % 8));
+            is_modified_ = true;
+        }
+
+        /** \brief Проверить, известно ли, что за день нет новостей
+         * \param timestamp Метка времени
+         * \return Вернет true, если сервер подтвердил отсутствие новостей за день
+         */
+        inline bool check_empty_day(const xtime::timestamp_t timestamp) const {
+            return check_bit(empty_days_, get_day(timestamp));
+        }
+
+        /** \brief Получить метки времени первого и последнего дня
+         * \param min_timestamp Метка времени начала первого дня
+         * \param max_timestamp Метка времени начала последнего дня
+         * \return Вернет true, если индекс содержит хотя бы один день
+         */
+        bool get_min_max_timestamp(xtime::timestamp_t &min_timestamp, xtime::timestamp_t &max_timestamp) const {
+            if(num_days_ == 0) return false;
+            min_timestamp = (xtime::timestamp_t)min_day_ * xtime::SECONDS_IN_DAY;
+            max_timestamp = (xtime::timestamp_t)max_day_ * xtime::SECONDS_IN_DAY;
+            return true;
+        }
+
+        /** \brief Получить количество дней с новостями
+         * \return Количество дней
+         */
+        uint32_t get_num_days() const {
+            return num_days_;
+        }
+
+        /** \brief Получить список дней без новостей
+         *
+         * Дни, для которых уже известно, что новостей нет (set_empty_day), в список не попадают.
+         * \param beg_timestamp Метка времени начала периода
+         * \param end_timestamp Метка времени конца периода (включительно)
+         * \param list_timestamp Список меток времени начала дней, за которые нет новостей
+         * \param is_skip_day_off Флаг пропуска выходных дней
+         */
+        void get_missing_days(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                std::vector<xtime::timestamp_t> &list_timestamp,
+                const bool is_skip_day_off = true) const {
+            list_timestamp.clear();
+            const uint32_t beg_day = get_day(beg_timestamp);
+            const uint32_t end_day = get_day(end_timestamp);
+            for(uint32_t day = beg_day; day <= end_day; ++day) {
+                if(check_day(day) || check_bit(empty_days_, day)) continue;
+                const xtime::timestamp_t t = (xtime::timestamp_t)day * xtime::SECONDS_IN_DAY;
+                if(is_skip_day_off && xtime::is_day_off(t)) continue;
+                list_timestamp.push_back(t);
+            }
+        }
+
+        /** \brief Запомнить хеш содержимого дня
+         * \param timestamp Метка времени дня
+         * \param hash Хеш содержимого дня
+         */
+        void set_hash(const xtime::timestamp_t timestamp, const uint64_t hash) {
+            hashes_[get_day(timestamp)] = hash;
+            is_modified_ = true;
+        }
+
+        /** \brief Получить хеш содержимого дня
+         * \param timestamp Метка времени дня
+         * \param hash Хеш содержимого дня
+         * \return Вернет true, если хеш дня известен
+         */
+        bool get_hash(const xtime::timestamp_t timestamp, uint64_t &hash) const {
+            auto it = hashes_.find(get_day(timestamp));
+            if(it == hashes_.end()) return false;
+            hash = it->second;
+            return true;
+        }
+
+        /** \brief Запомнить сводку новостей дня
+         * \param timestamp Метка времени дня
+         * \param summary Сводка новостей дня
+         */
+        void set_summary(const xtime::timestamp_t timestamp, const DaySummary &summary) {
+            summaries_[get_day(timestamp)] = summary;
+            is_modified_ = true;
+        }
+
+        /** \brief Забыть сводку новостей дня
+         *
+         * Нужно, когда день изменился, а новая сводка еще не посчитана
+         * \param timestamp Метка времени дня
+         */
+        void remove_summary(const xtime::timestamp_t timestamp) {
+            if(summaries_.erase(get_day(timestamp)) > 0) is_modified_ = true;
+        }
+
+        /** \brief Получить сводку новостей дня
+         * \param timestamp Метка времени дня
+         * \return Указатель на сводку или NULL, если сводка дня неизвестна
+         */
+        const DaySummary *get_summary(const xtime::timestamp_t timestamp) const {
+            auto it = summaries_.find(get_day(timestamp));
+            if(it == summaries_.end()) return NULL;
+            return &it->second;
+        }
+
+        /** \brief Проверить флаг изменения индекса
+         * \return Вернет true, если индекс изменился после загрузки или сохранения
+         */
+        bool is_modified() const {
+            return is_modified_;
+        }
+
+        /** \brief Загрузить индекс из файла
+         *
+         * Если индекс записан для другого размера хранилища, он считается устаревшим:
+         * битовая карта дней с новостями не загружается, ее нужно построить заново по хранилищу
+         * (clear_days, set_day и remove_missing_days). Дни без новостей, хеши и сводки загружаются,
+         * так как писатель убирает из файла хеши и сводки дней перед их изменением (см. save_before_change).
+         * \param file_name Имя файла индекса
+         * \param storage_size Текущий размер файла хранилища
+         * \param is_stale Флаг устаревшего индекса
+         * \return Вернет true в случае успеха
+         */
+        bool load(const std::string &file_name, const uint64_t storage_size, bool &is_stale) {
+            is_stale = false;
+            std::ifstream file(file_name, std::ios::binary);
+            if(!file) return false;
+            uint32_t magic = 0, version = 0;
+            uint64_t index_storage_size = 0, bitmap_size = 0;
+            if(!read_value(file, magic) || magic != MAGIC) return false;
+            if(!read_value(file, version) || version != VERSION) return false;
+            if(!read_value(file, index_storage_size)) return false;
+            if(!read_value(file, bitmap_size)) return false;
+            std::vector<uint8_t> days(bitmap_size);
+            if(bitmap_size > 0 && !file.read(reinterpret_cast<char*>(days.data()), bitmap_size)) return false;
+            uint64_t empty_bitmap_size = 0;
+            if(!read_value(file, empty_bitmap_size)) return false;
+            std::vector<uint8_t> empty_days(empty_bitmap_size);
+            if(empty_bitmap_size > 0 && !file.read(reinterpret_cast<char*>(empty_days.data()), empty_bitmap_size)) return false;
+            uint64_t num_hashes = 0;
+            if(!read_value(file, num_hashes)) return false;
+            std::unordered_map<uint32_t, uint64_t> hashes;
+            hashes.reserve(num_hashes);
+            for(uint64_t i = 0; i < num_hashes; ++i) {
+                uint32_t day = 0;
+                uint64_t hash = 0;
+                if(!read_value(file, day) || !read_value(file, hash)) return false;
+                hashes[day] = hash;
+            }
+            uint64_t num_summaries = 0;
+            if(!read_value(file, num_summaries)) return false;
+            std::unordered_map<uint32_t, DaySummary> summaries;
+            summaries.reserve(num_summaries);
+            for(uint64_t i = 0; i < num_summaries; ++i) {
+                uint32_t day = 0, num_currencies = 0;
+                uint64_t first_timestamp = 0, last_timestamp = 0;
+                DaySummary summary;
+                if(!read_value(file, day) ||
+                    !read_value(file, first_timestamp) ||
+                    !read_value(file, last_timestamp) ||
+                    !read_value(file, summary.num_news) ||
+                    !read_value(file, summary.num_previous) ||
+                    !read_value(file, summary.num_actual) ||
+                    !read_value(file, summary.num_forecast) ||
+                    !read_value(file, num_currencies)) return false;
+                summary.first_timestamp = first_timestamp;
+                summary.last_timestamp = last_timestamp;
+                summary.currencies.resize(num_currencies);
+                for(uint32_t n = 0; n < num_currencies; ++n) {
+                    DaySummary::CurrencyCount &count = summary.currencies[n];
+                    if(!read_value(file, count.code)) return false;
+                    for(int level = LOW; level <= HIGH; ++level) {
+                        if(!read_value(file, count.counts[level])) return false;
+                    }
+                }
+                summaries[day] = summary;
+            }
+            is_stale = index_storage_size != storage_size;
+            if(is_stale) days.clear();
+            days_.swap(days);
+            empty_days_.swap(empty_days);
+            hashes_.swap(hashes);
+            summaries_.swap(summaries);
+            update_min_max();
+            is_modified_ = is_stale;
+            return true;
+        }
+
+        /** \brief Сохранить индекс в файл
+         *
+         * Индекс записывается во временный файл, который затем заменяет файл индекса,
+         * поэтому читатели и сбой при записи не увидят индекс наполовину.
+         * \param file_name Имя файла индекса
+         * \param storage_size Размер файла хранилища на момент сохранения
+         * \return Вернет true в случае успеха
+         */
+        bool save(const std::string &file_name, const uint64_t storage_size) {
+            const std::string tmp_file_name = file_name + ".tmp";
+            if(!write_file(tmp_file_name, storage_size) ||
+                !replace_file(tmp_file_name, file_name)) {
+                std::remove(tmp_file_name.c_str());
+                return false;
+            }
+            is_modified_ = false;
+            return true;
+        }
+
+        /** \brief Сохранить индекс перед изменением дней в хранилище
+         *
+         * Хеши и сводки изменяемых дней в файл не попадают, поэтому, если запись хранилища прервется,
+         * индекс окажется устаревшим по размеру хранилища, но все хеши и сводки в нем останутся верны.
+         * Флаг изменения индекса не сбрасывается: после записи хранилища индекс нужно сохранить методом save.
+         * \param file_name Имя файла индекса
+         * \param storage_size Размер файла хранилища до изменения
+         * \param list_days Метки времени изменяемых дней
+         * \return Вернет true в случае успеха
+         */
+        bool save_before_change(
+                const std::string &file_name,
+                const uint64_t storage_size,
+                const std::vector<xtime::timestamp_t> &list_days) const {
+            std::unordered_set<uint32_t> skip_days;
+            for(size_t i = 0; i < list_days.size(); ++i) {
+                skip_days.insert(get_day(list_days[i]));
+            }
+            const std::string tmp_file_name = file_name + ".tmp";
+            if(!write_file(tmp_file_name, storage_size, &skip_days) ||
+                !replace_file(tmp_file_name, file_name)) {
+                std::remove(tmp_file_name.c_str());
+                return false;
+            }
+            return true;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_DATA_STORE_INDEX_HPP_INCLUDED
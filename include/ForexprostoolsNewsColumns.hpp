@@ -0,0 +1,469 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_NEWS_COLUMNS_HPP_INCLUDED
+#define FOREXPROSTOOLS_NEWS_COLUMNS_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <iterator>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /** \brief Таблица строк
+     *
+     * Каждой уникальной строке назначается номер, по которому строка хранится один раз.
+     */
+    class StringPool {
+    private:
+        std::vector<std::string> strings_;
+        std::unordered_map<std::string, uint32_t> ids_;
+
+    public:
+
+        StringPool() {};
+
+        /** \brief Получить номер строки, добавив ее при необходимости
+         * \param str Строка
+         * \return Номер строки
+         */
+        uint32_t add(const std::string &str) {
+            auto it = ids_.find(str);
+            if(it != ids_.end()) return it->second;
+            const uint32_t id = (uint32_t)strings_.size();
+            strings_.push_back(str);
+            ids_.emplace(str, id);
+            return id;
+        }
+
+        /** \brief Получить строку по номеру
+         * \param id Номер строки
+         * \return Строка
+         */
+        inline const std::string &get(const uint32_t id) const {
+            return strings_[id];
+        }
+
+        /** \brief Получить количество строк
+         * \return Количество строк
+         */
+        inline size_t size() const {
+            return strings_.size();
+        }
+
+        void clear() {
+            strings_.clear();
+            ids_.clear();
+        }
+    };
+
+    /** \brief Список новостей, хранящийся по столбцам
+     *
+     * В отличие от NewsList, каждое поле новостей хранится в отдельном непрерывном массиве:
+     * метки времени, уровни силы, номера валют, значения и флаги наличия значений.
+     * Строки (имена, валюты, страны) хранятся один раз в таблицах строк.
+     * Двоичный поиск читает только столбец меток времени, а фильтр по валютной паре
+     * читает только столбцы уровней силы и валют. Для обхода новостей по строкам есть
+     * представление Row и итератор.
+     * Таблицы строк не очищаются методом clear(), поэтому номера строк остаются прежними
+     * при повторной загрузке новостей.
+     */
+    class NewsColumns {
+    public:
+        /// Флаги наличия значений
+        enum {
+            FLAG_PREVIOUS = 0x01,
+            FLAG_ACTUAL = 0x02,
+            FLAG_FORECAST = 0x04,
+        };
+
+    private:
+        std::vector<xtime::timestamp_t> timestamps_;    /**< Метки времени новостей */
+        std::vector<int8_t> levels_;                    /**< Уровни силы новостей */
+        std::vector<uint32_t> currency_ids_;            /**< Номера валют в таблице валют */
+        std::vector<uint32_t> name_ids_;                /**< Номера имен в таблице имен */
+        std::vector<uint32_t> country_ids_;             /**< Номера стран в таблице стран */
+        std::vector<double> previous_;                  /**< Предыдущие значения */
+        std::vector<double> actual_;                    /**< Актуальные значения */
+        std::vector<double> forecast_;                  /**< Предсказанные значения */
+        std::vector<uint8_t> flags_;                    /**< Флаги наличия значений */
+
+        StringPool currencies_;                         /**< Таблица валют */
+        std::vector<uint32_t> currency_codes_;          /**< Упакованные коды валют по номерам в таблице валют */
+        StringPool names_;                              /**< Таблица имен */
+        StringPool countries_;                          /**< Таблица стран */
+
+        std::vector<size_t> order_;                     /**< Буфер перестановки при сортировке */
+
+        template<class T>
+        static void apply_order(std::vector<T> &column, const std::vector<size_t> &order, const size_t offset) {
+            std::vector<T> sorted(order.size());
+            for(size_t i = 0; i < order.size(); ++i) sorted[i] = column[offset + order[i]];
+            std::copy(sorted.begin(), sorted.end(), column.begin() + offset);
+        }
+
+        template<class T>
+        static void merge_column(std::vector<T> &column, const std::vector<size_t> &order) {
+            std::vector<T> merged(order.size());
+            for(size_t i = 0; i < order.size(); ++i) merged[i] = column[order[i]];
+            column.swap(merged);
+        }
+
+        /** \brief Упорядочить строки [offset, size()) и слить их с уже отсортированными
+         * \param middle Количество строк, которые уже были отсортированы
+         */
+        void sort_rows(const size_t middle) {
+            const size_t num_rows = timestamps_.size();
+            /* новости обычно добавляются по дням в порядке возрастания */
+            if(!std::is_sorted(timestamps_.begin() + middle, timestamps_.end())) {
+                order_.resize(num_rows - middle);
+                for(size_t i = 0; i < order_.size(); ++i) order_[i] = i;
+                std::stable_sort(order_.begin(), order_.end(), [&](const size_t lhs, const size_t rhs) {
+                    return timestamps_[middle + lhs] < timestamps_[middle + rhs];
+                });
+                apply_all(order_, middle, false);
+            }
+            if(middle == 0 || middle == num_rows || timestamps_[middle] >= timestamps_[middle - 1]) return;
+            order_.resize(num_rows);
+            for(size_t i = 0; i < num_rows; ++i) order_[i] = i;
+            std::inplace_merge(order_.begin(), order_.begin() + middle, order_.end(), [&](const size_t lhs, const size_t rhs) {
+                return timestamps_[lhs] < timestamps_[rhs];
+            });
+            apply_all(order_, 0, true);
+        }
+
+        void apply_all(const std::vector<size_t> &order, const size_t offset, const bool is_merge) {
+            if(is_merge) {
+                merge_column(timestamps_, order);
+                merge_column(levels_, order);
+                merge_column(currency_ids_, order);
+                merge_column(name_ids_, order);
+                merge_column(country_ids_, order);
+                merge_column(previous_, order);
+                merge_column(actual_, order);
+                merge_column(forecast_, order);
+                merge_column(flags_, order);
+                return;
+            }
+            apply_order(timestamps_, order, offset);
+            apply_order(levels_, order, offset);
+            apply_order(currency_ids_, order, offset);
+            apply_order(name_ids_, order, offset);
+            apply_order(country_ids_, order, offset);
+            apply_order(previous_, order, offset);
+            apply_order(actual_, order, offset);
+            apply_order(forecast_, order, offset);
+            apply_order(flags_, order, offset);
+        }
+
+    public:
+
+        /** \brief Представление одной новости списка
+         */
+        class Row {
+        private:
+            const NewsColumns *list_;
+            size_t index_;
+        public:
+            Row(const NewsColumns *list, const size_t index) : list_(list), index_(index) {};
+
+            inline size_t get_index() const {return index_;}
+            inline xtime::timestamp_t get_timestamp() const {return list_->timestamps_[index_];}
+            inline int get_level_volatility() const {return list_->levels_[index_];}
+            inline const std::string &get_currency() const {return list_->currencies_.get(list_->currency_ids_[index_]);}
+            inline CurrencyCode get_currency_code() const {return CurrencyCode(list_->currency_codes_[list_->currency_ids_[index_]]);}
+            inline const std::string &get_name() const {return list_->names_.get(list_->name_ids_[index_]);}
+            inline const std::string &get_country() const {return list_->countries_.get(list_->country_ids_[index_]);}
+            inline double get_previous() const {return list_->previous_[index_];}
+            inline double get_actual() const {return list_->actual_[index_];}
+            inline double get_forecast() const {return list_->forecast_[index_];}
+            inline bool is_previous() const {return (list_->flags_[index_] & FLAG_PREVIOUS) != 0;}
+            inline bool is_actual() const {return (list_->flags_[index_] & FLAG_ACTUAL) != 0;}
+            inline bool is_forecast() const {return (list_->flags_[index_] & FLAG_FORECAST) != 0;}
+
+            /** \brief Получить новость
+             * \param news Новость
+             */
+            void get(News &news) const {
+                news.timestamp = get_timestamp();
+                news.level_volatility = get_level_volatility();
+                news.currency = get_currency();
+                news.name = get_name();
+                news.country = get_country();
+                news.previous = get_previous();
+                news.actual = get_actual();
+                news.forecast = get_forecast();
+                news.is_previous = is_previous();
+                news.is_actual = is_actual();
+                news.is_forecast = is_forecast();
+            }
+
+            /** \brief Получить новость
+             * \return Новость
+             */
+            News to_news() const {
+                News news;
+                get(news);
+                return news;
+            }
+        };
+
+        /** \brief Итератор по новостям списка
+         */
+        class const_iterator {
+        private:
+            const NewsColumns *list_ = nullptr;
+            size_t index_ = 0;
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef Row value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Row* pointer;
+            typedef Row reference;
+
+            const_iterator() {};
+            const_iterator(const NewsColumns *list, const size_t index) : list_(list), index_(index) {};
+
+            inline Row operator * () const {return Row(list_, index_);}
+            inline Row operator [] (const std::ptrdiff_t n) const {return Row(list_, index_ + n);}
+            inline const_iterator &operator ++ () {++index_; return *this;}
+            inline const_iterator operator ++ (int) {const_iterator it(*this); ++index_; return it;}
+            inline const_iterator &operator -- () {--index_; return *this;}
+            inline const_iterator operator -- (int) {const_iterator it(*this); --index_; return it;}
+            inline const_iterator &operator += (const std::ptrdiff_t n) {index_ += n; return *this;}
+            inline const_iterator &operator -= (const std::ptrdiff_t n) {index_ -= n; return *this;}
+            inline const_iterator operator + (const std::ptrdiff_t n) const {return const_iterator(list_, index_ + n);}
+            inline const_iterator operator - (const std::ptrdiff_t n) const {return const_iterator(list_, index_ - n);}
+            inline std::ptrdiff_t operator - (const const_iterator &other) const {return (std::ptrdiff_t)index_ - (std::ptrdiff_t)other.index_;}
+            inline bool operator == (const const_iterator &other) const {return index_ == other.index_;}
+            inline bool operator != (const const_iterator &other) const {return index_ != other.index_;}
+            inline bool operator < (const const_iterator &other) const {return index_ < other.index_;}
+            inline bool operator > (const const_iterator &other) const {return index_ > other.index_;}
+            inline bool operator <= (const const_iterator &other) const {return index_ <= other.index_;}
+            inline bool operator >= (const const_iterator &other) const {return index_ >= other.index_;}
+            friend inline const_iterator operator + (const std::ptrdiff_t n, const const_iterator &it) {return it + n;}
+        };
+
+        NewsColumns() {};
+
+        /** \brief Инициализировать список новостей
+         * \param list_news список новостей
+         */
+        NewsColumns(const std::vector<News> &list_news) {
+            add_news(list_news);
+        }
+
+        /** \brief Добавить новости
+         * \param list_news список новостей
+         */
+        void add_news(const std::vector<News> &list_news) {
+            if(list_news.size() == 0) return;
+            const size_t middle = timestamps_.size();
+            const size_t num_rows = middle + list_news.size();
+            timestamps_.reserve(num_rows);
+            levels_.reserve(num_rows);
+            currency_ids_.reserve(num_rows);
+            name_ids_.reserve(num_rows);
+            country_ids_.reserve(num_rows);
+            previous_.reserve(num_rows);
+            actual_.reserve(num_rows);
+            forecast_.reserve(num_rows);
+            flags_.reserve(num_rows);
+            for(size_t i = 0; i < list_news.size(); ++i) {
+                const News &news = list_news[i];
+                timestamps_.push_back(news.timestamp);
+                levels_.push_back((int8_t)news.level_volatility);
+                const uint32_t currency_id = currencies_.add(news.currency);
+                if(currency_id == currency_codes_.size()) currency_codes_.push_back(CurrencyCode::pack(news.currency));
+                currency_ids_.push_back(currency_id);
+                name_ids_.push_back(names_.add(news.name));
+                country_ids_.push_back(countries_.add(news.country));
+                previous_.push_back(news.previous);
+                actual_.push_back(news.actual);
+                forecast_.push_back(news.forecast);
+                uint8_t flags = 0;
+                if(news.is_previous) flags |= FLAG_PREVIOUS;
+                if(news.is_actual) flags |= FLAG_ACTUAL;
+                if(news.is_forecast) flags |= FLAG_FORECAST;
+                flags_.push_back(flags);
+            }
+            sort_rows(middle);
+        }
+
+        /** \brief Очистить список новостей
+         *
+         * Таблицы строк сохраняются
+         */
+        void clear() {
+            timestamps_.clear();
+            levels_.clear();
+            currency_ids_.clear();
+            name_ids_.clear();
+            country_ids_.clear();
+            previous_.clear();
+            actual_.clear();
+            forecast_.clear();
+            flags_.clear();
+        }
+
+        inline size_t size() const {
+            return timestamps_.size();
+        }
+
+        inline bool empty() const {
+            return timestamps_.empty();
+        }
+
+        inline Row operator [] (const size_t index) const {
+            return Row(this, index);
+        }
+
+        inline const_iterator begin() const {
+            return const_iterator(this, 0);
+        }
+
+        inline const_iterator end() const {
+            return const_iterator(this, size());
+        }
+
+        /** \brief Получить столбец меток времени
+         * \return Метки времени новостей в порядке возрастания
+         */
+        inline const std::vector<xtime::timestamp_t> &get_timestamps() const {
+            return timestamps_;
+        }
+
+        /** \brief Получить столбец уровней силы
+         * \return Уровни силы новостей
+         */
+        inline const std::vector<int8_t> &get_levels() const {
+            return levels_;
+        }
+
+        /** \brief Получить столбец номеров валют
+         * \return Номера валют новостей в таблице валют (см. get_currency_codes)
+         */
+        inline const std::vector<uint32_t> &get_currency_ids() const {
+            return currency_ids_;
+        }
+
+        /** \brief Получить упакованные коды валют таблицы валют
+         * \return Коды валют по номерам в таблице валют
+         */
+        inline const std::vector<uint32_t> &get_currency_codes() const {
+            return currency_codes_;
+        }
+
+        /** \brief Получить упакованный код валюты новости
+         * \param index Номер новости
+         * \return Код валюты
+         */
+        inline CurrencyCode get_currency_code(const size_t index) const {
+            return CurrencyCode(currency_codes_[currency_ids_[index]]);
+        }
+
+        /** \brief Найти диапазон новостей по метке времени
+         *
+         * Коды ошибок совпадают с NewsList::get_news
+         * \param timestamp Метка времени
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param beg_index Номер первой новости диапазона
+         * \param end_index Номер новости после последней новости диапазона
+         * \return Вернет 0 в случае успеха
+         */
+        int get_range(
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                size_t &beg_index,
+                size_t &end_index) const {
+            beg_index = end_index = 0;
+            if(timestamps_.size() == 0) return NO_DATA_ACCESS;
+            const xtime::timestamp_t start_time = timestamp - indent_timestamp_past;
+            const xtime::timestamp_t stop_time = timestamp + indent_timestamp_future;
+            auto lower = std::lower_bound(timestamps_.begin(), timestamps_.end(), start_time);
+            auto upper = std::upper_bound(timestamps_.begin(), timestamps_.end(), stop_time);
+            if(lower == timestamps_.end() && upper == timestamps_.end()) return NO_DATA_ACCESS;
+            if(lower == timestamps_.begin() && upper == timestamps_.begin()) return NO_DATA_ACCESS;
+            beg_index = lower - timestamps_.begin();
+            end_index = std::max(beg_index, (size_t)(upper - timestamps_.begin()));
+            return OK;
+        }
+
+        /** \brief Получить новости по метке времени
+         * \param timestamp Метка времени
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param list_news Список новостей
+         * \return Вернет 0 в случае успеха
+         */
+        int get_news(
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                std::vector<News> &list_news) const {
+            size_t beg_index = 0, end_index = 0;
+            int err = get_range(timestamp, indent_timestamp_past, indent_timestamp_future, beg_index, end_index);
+            if(err != OK) return err;
+            /* элементы массива не удаляются, чтобы строки могли повторно использовать свою память */
+            list_news.resize(end_index - beg_index);
+            for(size_t i = beg_index; i < end_index; ++i) {
+                Row(this, i).get(list_news[i - beg_index]);
+            }
+            return OK;
+        }
+
+        /** \brief Получить состояние фильтра для диапазона новостей
+         *
+         * Читаются только столбцы уровней силы и валют.
+         * \param pair Валютная пара
+         * \param beg_index Номер первой новости диапазона
+         * \param end_index Номер новости после последней новости диапазона
+         * \param is_only_select Использовать только выбранные уровни силы новости
+         * \param is_low Использовать слабые новости
+         * \param is_moderate Использовать новости средней силы
+         * \param is_high Использовать сильные новости
+         * \return Состояние фильтра (NEWS_FOUND или NO_NEWS)
+         */
+        int get_filter_state(
+                const CurrencyPair &pair,
+                const size_t beg_index,
+                const size_t end_index,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high) const {
+            const bool is_select[HIGH + 1] = {is_low, is_moderate, is_high};
+            int state = NO_NEWS;
+            for(size_t i = beg_index; i < end_index; ++i) {
+                const int level = levels_[i];
+                if(level < LOW || level > HIGH) continue;
+                if(!pair.check(CurrencyCode(currency_codes_[currency_ids_[i]]))) continue;
+                if(is_select[level]) state = NEWS_FOUND;
+                else if(is_only_select) return NO_NEWS;
+            }
+            return state;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_NEWS_COLUMNS_HPP_INCLUDED
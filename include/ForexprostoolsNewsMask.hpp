@@ -0,0 +1,424 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_NEWS_MASK_HPP_INCLUDED
+#define FOREXPROSTOOLS_NEWS_MASK_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsDataStore.hpp>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsDataStore {
+
+    /** \brief Параметры временной маски новостей
+     *
+     * Параметры совпадают с параметрами метода DataStore::is_news
+     */
+    class NewsMaskConfig {
+    public:
+        std::string pair_name;                  /**< Имя валютной пары */
+        xtime::timestamp_t indent_past = 0;     /**< Максимальный отступ до метки времени */
+        xtime::timestamp_t indent_future = 0;   /**< Максимальный отступ после метки времени */
+        bool is_only_select = false;            /**< Использовать только выбранные уровни силы новости */
+        bool is_low = false;                    /**< Использовать слабые новости */
+        bool is_moderate = false;               /**< Использовать новости средней силы */
+        bool is_high = true;                    /**< Использовать сильные новости */
+
+        NewsMaskConfig() {};
+    };
+
+    /** \brief Формат файла временной маски новостей
+     *
+     * Файл начинается с заголовка, за которым идут блоки дней одинакового размера.
+     * Блок дня содержит хеш дней хранилища, от которых зависит маска, и по одному биту на каждую минуту дня.
+     * Бит минуты равен 1, если is_news для начала этой минуты вернул бы true.
+     */
+    class NewsMaskFormat {
+    public:
+        enum {
+            MAGIC = 0x4D4E5046,                 /**< Сигнатура файла маски ("FPNM") */
+            VERSION = 1,                        /**< Версия формата файла маски */
+            HEADER_SIZE = 64,                   /**< Размер заголовка */
+            MINUTES_IN_DAY = 1440,              /**< Количество минут в дне */
+            DAY_BITS_SIZE = MINUTES_IN_DAY / 8, /**< Размер битовой маски дня */
+            DAY_BLOCK_SIZE = 192,               /**< Размер блока дня (хеш, маска и выравнивание) */
+            FLAG_LOW = 0x01,
+            FLAG_MODERATE = 0x02,
+            FLAG_HIGH = 0x04,
+            FLAG_ONLY_SELECT = 0x100,
+        };
+
+        /** \brief Заголовок файла маски
+         */
+        class Header {
+        public:
+            uint32_t magic = MAGIC;
+            uint32_t version = VERSION;
+            char pair_name[8];
+            uint64_t indent_past = 0;
+            uint64_t indent_future = 0;
+            uint32_t flags = 0;
+            uint32_t reserved = 0;
+            uint64_t beg_timestamp = 0;         /**< Метка времени начала первого дня */
+            uint64_t num_days = 0;              /**< Количество дней */
+            uint64_t reserved2 = 0;
+
+            Header() {
+                static_assert(sizeof(Header) == HEADER_SIZE, "NewsMaskFormat::Header size");
+                std::memset(pair_name, 0, sizeof(pair_name));
+            };
+
+            /** \brief Заполнить параметры маски
+             * \param config Параметры маски
+             */
+            void set_config(const NewsMaskConfig &config) {
+                std::memset(pair_name, 0, sizeof(pair_name));
+                std::string currency_1, currency_2;
+                if(ForexprostoolsApiEasy::get_currencies(config.pair_name, currency_1, currency_2) == ForexprostoolsApiEasy::OK) {
+                    const std::string name = currency_1 + currency_2;
+                    std::memcpy(pair_name, name.c_str(), std::min(name.size(), sizeof(pair_name)));
+                }
+                indent_past = config.indent_past;
+                indent_future = config.indent_future;
+                flags = 0;
+                if(config.is_low) flags |= FLAG_LOW;
+                if(config.is_moderate) flags |= FLAG_MODERATE;
+                if(config.is_high) flags |= FLAG_HIGH;
+                if(config.is_only_select) flags |= FLAG_ONLY_SELECT;
+            }
+
+            /** \brief Проверить, что маска построена с теми же параметрами
+             * \param other Заголовок другой маски
+             * \return Вернет true, если параметры совпадают
+             */
+            bool is_same_config(const Header &other) const {
+                return std::memcmp(pair_name, other.pair_name, sizeof(pair_name)) == 0 &&
+                    indent_past == other.indent_past &&
+                    indent_future == other.indent_future &&
+                    flags == other.flags;
+            }
+        };
+    };
+
+    /** \brief Построить или обновить временную маску новостей
+     *
+     * Если файл маски уже построен с теми же параметрами, пересчитываются только дни,
+     * для которых изменился хеш хотя бы одного дня хранилища, попадающего в отступы.
+     * Файл записывается во временный файл и затем заменяет старый (см. replace_file).
+     * В POSIX уже отображенная в память маска остается корректной.
+     * В Windows файл, отображенный в память, заменить нельзя: пока маска открыта (NewsMask),
+     * функция вернет WRITE_ERROR, а старый файл маски останется на месте.
+     * \param store Хранилище новостей
+     * \param file_name Имя файла маски
+     * \param config Параметры маски
+     * \param beg_timestamp Метка времени начала маски
+     * \param end_timestamp Метка времени конца маски (включительно)
+     * \param num_updated_days Количество пересчитанных дней
+     * \return Вернет 0 в случае успеха
+     */
+    inline int update_news_mask(
+            DataStore &store,
+            const std::string &file_name,
+            const NewsMaskConfig &config,
+            const xtime::timestamp_t beg_timestamp,
+            const xtime::timestamp_t end_timestamp,
+            uint32_t &num_updated_days) {
+        typedef NewsMaskFormat F;
+        num_updated_days = 0;
+        std::string currency_1, currency_2;
+        int err = ForexprostoolsApiEasy::get_currencies(config.pair_name, currency_1, currency_2);
+        if(err != OK) return err;
+        if(beg_timestamp > end_timestamp) return INVALID_PARAMETER;
+
+        F::Header header;
+        header.set_config(config);
+        header.beg_timestamp = xtime::get_first_timestamp_day(beg_timestamp);
+        header.num_days = (xtime::get_first_timestamp_day(end_timestamp) - header.beg_timestamp) / xtime::SECONDS_IN_DAY + 1;
+
+        std::vector<uint8_t> blocks((size_t)header.num_days * F::DAY_BLOCK_SIZE, 0);
+        std::vector<bool> is_old_day(header.num_days, false);
+
+        /* загрузим старую маску, если она построена с теми же параметрами */
+        {
+            std::ifstream file(file_name, std::ios::binary);
+            F::Header old_header;
+            if(file && file.read(reinterpret_cast<char*>(&old_header), sizeof(old_header)) &&
+                old_header.magic == (uint32_t)F::MAGIC &&
+                old_header.version == (uint32_t)F::VERSION &&
+                header.is_same_config(old_header)) {
+                std::vector<uint8_t> block(F::DAY_BLOCK_SIZE);
+                for(uint64_t i = 0; i < old_header.num_days; ++i) {
+                    if(!file.read(reinterpret_cast<char*>(block.data()), block.size())) break;
+                    const xtime::timestamp_t t = old_header.beg_timestamp + i * xtime::SECONDS_IN_DAY;
+                    if(t < header.beg_timestamp) continue;
+                    const uint64_t day = (t - header.beg_timestamp) / xtime::SECONDS_IN_DAY;
+                    if(day >= header.num_days) break;
+                    std::memcpy(&blocks[(size_t)day * F::DAY_BLOCK_SIZE], block.data(), block.size());
+                    is_old_day[day] = true;
+                }
+            }
+        }
+
+        NewsPredicate predicate;
+        predicate.currencies.insert(currency_1);
+        predicate.currencies.insert(currency_2);
+        const uint32_t select_mask = header.flags & (F::FLAG_LOW | F::FLAG_MODERATE | F::FLAG_HIGH);
+        std::vector<News> list_news;
+        std::vector<uint64_t> hash_data;
+        std::vector<uint8_t> found_bits(F::DAY_BITS_SIZE), block_bits(F::DAY_BITS_SIZE);
+
+        for(uint64_t day = 0; day < header.num_days; ++day) {
+            const xtime::timestamp_t day_timestamp = header.beg_timestamp + day * xtime::SECONDS_IN_DAY;
+            const xtime::timestamp_t last_minute = day_timestamp + xtime::SECONDS_IN_DAY - xtime::SECONDS_IN_MINUTE;
+            const xtime::timestamp_t window_beg = day_timestamp > config.indent_past ? day_timestamp - config.indent_past : 0;
+            const xtime::timestamp_t window_end = last_minute + config.indent_future;
+
+            /* хеш маски дня зависит от всех дней хранилища, попадающих в отступы */
+            hash_data.clear();
+            for(xtime::timestamp_t t = xtime::get_first_timestamp_day(window_beg);
+                t <= window_end;
+                t += xtime::SECONDS_IN_DAY) {
+                uint64_t day_hash = 0;
+                if(store.check_timestamp(t) && store.get_day_hash(t, day_hash) == OK) {
+                    hash_data.push_back(t);
+                    hash_data.push_back(day_hash);
+                }
+            }
+            const uint64_t hash = hash_data.empty() ? 0 :
+                ForexprostoolsApiEasy::get_hash(reinterpret_cast<const char*>(hash_data.data()), hash_data.size() * sizeof(uint64_t));
+            uint8_t *block = &blocks[(size_t)day * F::DAY_BLOCK_SIZE];
+            uint64_t old_hash = 0;
+            std::memcpy(&old_hash, block, sizeof(old_hash));
+            if(is_old_day[day] && old_hash == hash) continue;
+
+            std::fill(found_bits.begin(), found_bits.end(), 0);
+            std::fill(block_bits.begin(), block_bits.end(), 0);
+            if(hash != 0) {
+                err = store.query(window_beg, window_end, predicate, list_news);
+                if(err != OK) return err;
+            } else {
+                list_news.clear();
+            }
+            for(size_t n = 0; n < list_news.size(); ++n) {
+                const int level = list_news[n].level_volatility;
+                if(level < ForexprostoolsApiEasy::LOW || level > ForexprostoolsApiEasy::HIGH) continue;
+                const bool is_select = (select_mask & (1 << level)) != 0;
+                if(!is_select && !config.is_only_select) continue;
+                std::vector<uint8_t> &bits = is_select ? found_bits : block_bits;
+                /* новость видна с минут t, для которых t - indent_past <= timestamp <= t + indent_future */
+                const long long first = (long long)list_news[n].timestamp - (long long)config.indent_future - (long long)day_timestamp;
+                const long long last = (long long)list_news[n].timestamp + (long long)config.indent_past - (long long)day_timestamp;
+                long long first_minute = first <= 0 ? 0 : (first + xtime::SECONDS_IN_MINUTE - 1) / xtime::SECONDS_IN_MINUTE;
+                long long last_minute_index = last < 0 ? -1 : last / xtime::SECONDS_IN_MINUTE;
+                if(last_minute_index >= F::MINUTES_IN_DAY) last_minute_index = F::MINUTES_IN_DAY - 1;
+                for(long long m = first_minute; m <= last_minute_index; ++m) {
+                    bits[m / 8] |= (uint8_t)(1 << (m % 8));
+                }
+            }
+            /* при is_only_select любая новость с невыбранным уровнем отменяет найденные */
+            for(size_t i = 0; i < F::DAY_BITS_SIZE; ++i) {
+                found_bits[i] &= (uint8_t)~block_bits[i];
+            }
+            std::memcpy(block, &hash, sizeof(hash));
+            std::memcpy(block + sizeof(hash), found_bits.data(), found_bits.size());
+            ++num_updated_days;
+        }
+
+        const std::string tmp_file_name = file_name + ".tmp";
+        {
+            std::ofstream file(tmp_file_name, std::ios::binary | std::ios::trunc);
+            if(!file) return WRITE_ERROR;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+            if(!file) return WRITE_ERROR;
+        }
+        if(!replace_file(tmp_file_name, file_name)) {
+            std::remove(tmp_file_name.c_str());
+            return WRITE_ERROR;
+        }
+        return OK;
+    }
+
+    /** \brief Временная маска новостей
+     *
+     * Файл маски отображается в память, проверка минуты требует одного обращения к памяти.
+     */
+    class NewsMask {
+    private:
+        const uint8_t *data_ = nullptr;
+        size_t size_ = 0;
+        NewsMaskFormat::Header header_;
+#       if defined(_WIN32)
+        HANDLE file_handle_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_handle_ = NULL;
+#       else
+        int fd_ = -1;
+#       endif
+
+        NewsMask(const NewsMask&) = delete;
+        NewsMask& operator=(const NewsMask&) = delete;
+
+    public:
+
+        NewsMask() {};
+
+        /** \brief Открыть файл маски
+         * \param file_name Имя файла маски
+         */
+        NewsMask(const std::string &file_name) {
+            open(file_name);
+        }
+
+        ~NewsMask() {
+            close();
+        }
+
+        /** \brief Открыть файл маски
+         * \param file_name Имя файла маски
+         * \return Вернет true в случае успеха
+         */
+        bool open(const std::string &file_name) {
+            typedef NewsMaskFormat F;
+            close();
+#           if defined(_WIN32)
+            file_handle_ = CreateFileA(
+                file_name.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                NULL,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL,
+                NULL);
+            if(file_handle_ == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER file_size;
+            if(!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart < F::HEADER_SIZE) {
+                close();
+                return false;
+            }
+            mapping_handle_ = CreateFileMappingA(file_handle_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if(mapping_handle_ == NULL) {
+                close();
+                return false;
+            }
+            data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+            size_ = (size_t)file_size.QuadPart;
+#           else
+            fd_ = ::open(file_name.c_str(), O_RDONLY);
+            if(fd_ < 0) return false;
+            struct stat st;
+            if(fstat(fd_, &st) != 0 || st.st_size < F::HEADER_SIZE) {
+                close();
+                return false;
+            }
+            void *ptr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd_, 0);
+            if(ptr == MAP_FAILED) {
+                close();
+                return false;
+            }
+            data_ = static_cast<const uint8_t*>(ptr);
+            size_ = (size_t)st.st_size;
+#           endif
+            if(data_ == nullptr) {
+                close();
+                return false;
+            }
+            std::memcpy(&header_, data_, sizeof(header_));
+            if(header_.magic != (uint32_t)F::MAGIC ||
+                header_.version != (uint32_t)F::VERSION ||
+                size_ < F::HEADER_SIZE + header_.num_days * F::DAY_BLOCK_SIZE) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        /** \brief Закрыть файл маски
+         */
+        void close() {
+#           if defined(_WIN32)
+            if(data_ != nullptr) UnmapViewOfFile(data_);
+            if(mapping_handle_ != NULL) CloseHandle(mapping_handle_);
+            if(file_handle_ != INVALID_HANDLE_VALUE) CloseHandle(file_handle_);
+            mapping_handle_ = NULL;
+            file_handle_ = INVALID_HANDLE_VALUE;
+#           else
+            if(data_ != nullptr) munmap(const_cast<uint8_t*>(data_), size_);
+            if(fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+#           endif
+            data_ = nullptr;
+            size_ = 0;
+            header_ = NewsMaskFormat::Header();
+        }
+
+        /** \brief Проверить, открыт ли файл маски
+         * \return Вернет true, если маска открыта
+         */
+        bool is_open() const {
+            return data_ != nullptr;
+        }
+
+        /** \brief Получить метки времени начала и конца маски
+         * \param min_timestamp Метка времени начала первого дня
+         * \param max_timestamp Метка времени начала последнего дня
+         * \return Вернет true, если маска открыта и не пуста
+         */
+        bool get_min_max_timestamp(xtime::timestamp_t &min_timestamp, xtime::timestamp_t &max_timestamp) const {
+            if(!is_open() || header_.num_days == 0) return false;
+            min_timestamp = header_.beg_timestamp;
+            max_timestamp = header_.beg_timestamp + (header_.num_days - 1) * xtime::SECONDS_IN_DAY;
+            return true;
+        }
+
+        /** \brief Проверить наличие новостей
+         *
+         * Метка времени округляется вниз до начала минуты.
+         * \param timestamp Метка времени
+         * \return Вернет true, если для минуты есть новость по параметрам маски.
+         * Вне диапазона маски вернет false
+         */
+        inline bool check(const xtime::timestamp_t timestamp) const {
+            typedef NewsMaskFormat F;
+            if(timestamp < header_.beg_timestamp) return false;
+            const uint64_t offset = timestamp - header_.beg_timestamp;
+            const uint64_t day = offset / xtime::SECONDS_IN_DAY;
+            if(day >= header_.num_days) return false;
+            const uint64_t minute = (offset % xtime::SECONDS_IN_DAY) / xtime::SECONDS_IN_MINUTE;
+            const uint8_t *bits = data_ + F::HEADER_SIZE + day * F::DAY_BLOCK_SIZE + sizeof(uint64_t);
+            return (bits[minute / 8] & (1 << (minute % 8))) != 0;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_NEWS_MASK_HPP_INCLUDED
@@ -0,0 +1,134 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_NEWS_PREDICATE_HPP_INCLUDED
+#define FOREXPROSTOOLS_NEWS_PREDICATE_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <set>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /// Маски уровней волатильности для NewsPredicate
+    enum VolatilityMask {
+        VOLATILITY_LOW = 1 << LOW,              ///< Новости слабой силы
+        VOLATILITY_MODERATE = 1 << MODERATE,    ///< Новости средней силы
+        VOLATILITY_HIGH = 1 << HIGH,            ///< Сильные новости
+        VOLATILITY_ALL = VOLATILITY_LOW | VOLATILITY_MODERATE | VOLATILITY_HIGH,
+    };
+
+    /** \brief Условие отбора новостей
+     *
+     * Пустой набор (валют, стран, имен) означает, что по этому полю новости не отбираются.
+     * Условие можно проверить как для новости, так и для JSON объекта новости из хранилища,
+     * чтобы не декодировать новости, которые все равно будут отброшены.
+     */
+    class NewsPredicate {
+    public:
+        std::set<std::string> currencies;           /**< Валюты новостей */
+        std::set<std::string> countries;            /**< Страны новостей */
+        std::set<std::string> names;                /**< Имена новостей */
+        std::vector<std::string> name_prefixes;     /**< Начала имен новостей */
+        uint32_t volatility_mask = VOLATILITY_ALL;  /**< Маска уровней волатильности (VolatilityMask) */
+        bool is_need_previous = false;              /**< Нужны только новости с предыдущим значением */
+        bool is_need_actual = false;                /**< Нужны только новости с актуальным значением */
+        bool is_need_forecast = false;              /**< Нужны только новости с предсказанным значением */
+
+        NewsPredicate() {};
+
+        /** \brief Установить валюты валютной пары
+         * \param pair_name Имя валютной пары (например, EURUSD)
+         * \return Вернет 0 в случае успеха
+         */
+        int set_pair(const std::string &pair_name) {
+            CurrencyPair pair;
+            int err = pair.parse(pair_name);
+            if(err != OK) return err;
+            currencies.clear();
+            currencies.insert(pair.get_base().to_str());
+            currencies.insert(pair.get_quote().to_str());
+            return OK;
+        }
+
+        /** \brief Установить минимальный уровень волатильности
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         */
+        void set_min_volatility(const int min_level_volatility) {
+            volatility_mask = 0;
+            for(int level = LOW; level <= HIGH; ++level) {
+                if(level >= min_level_volatility) volatility_mask |= (1 << level);
+            }
+        }
+
+        /** \brief Проверить имя новости
+         * \param name Имя новости
+         * \return Вернет true, если имя подходит
+         */
+        bool check_name(const std::string &name) const {
+            if(names.empty() && name_prefixes.empty()) return true;
+            if(names.find(name) != names.end()) return true;
+            for(size_t i = 0; i < name_prefixes.size(); ++i) {
+                if(name.compare(0, name_prefixes[i].size(), name_prefixes[i]) == 0) return true;
+            }
+            return false;
+        }
+
+        /** \brief Проверить новость
+         * \param news Новость
+         * \return Вернет true, если новость подходит
+         */
+        bool check(const News &news) const {
+            if(news.level_volatility < LOW || news.level_volatility > HIGH) return false;
+            if((volatility_mask & (1 << news.level_volatility)) == 0) return false;
+            if(is_need_previous && !news.is_previous) return false;
+            if(is_need_actual && !news.is_actual) return false;
+            if(is_need_forecast && !news.is_forecast) return false;
+            if(!currencies.empty() && currencies.find(news.currency) == currencies.end()) return false;
+            if(!countries.empty() && countries.find(news.country) == countries.end()) return false;
+            return check_name(news.name);
+        }
+
+        /** \brief Проверить JSON объект новости
+         *
+         * Сначала проверяются дешевые поля (волатильность и наличие значений), затем строки.
+         * Строки сравниваются без копирования.
+         * \param item JSON объект новости в формате хранилища
+         * \return Вернет true, если новость подходит
+         */
+        bool check(const nlohmann::json &item) const {
+            const int level_volatility = item.at("volatility").get<int>();
+            if(level_volatility < LOW || level_volatility > HIGH) return false;
+            if((volatility_mask & (1 << level_volatility)) == 0) return false;
+            if(is_need_previous && item.find("previous") == item.end()) return false;
+            if(is_need_actual && item.find("actual") == item.end()) return false;
+            if(is_need_forecast && item.find("forecast") == item.end()) return false;
+            if(!currencies.empty() &&
+                currencies.find(item.at("currency").get_ref<const std::string&>()) == currencies.end()) return false;
+            if(!countries.empty() &&
+                countries.find(item.at("country").get_ref<const std::string&>()) == countries.end()) return false;
+            if(names.empty() && name_prefixes.empty()) return true;
+            return check_name(item.at("name").get_ref<const std::string&>());
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_NEWS_PREDICATE_HPP_INCLUDED
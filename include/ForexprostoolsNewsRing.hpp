@@ -0,0 +1,513 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_NEWS_RING_HPP_INCLUDED
+#define FOREXPROSTOOLS_NEWS_RING_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <atomic>
+#include <cstring>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /** \brief Формат кольцевого буфера новостей в общей памяти
+     *
+     * Буфер состоит из заголовка и массива слотов одинакового размера.
+     * Каждый слот защищен счетчиком последовательности (seqlock): во время записи
+     * счетчик нечетный, после записи равен 2 * (номер сообщения + 1).
+     * Писатель один, читателей может быть сколько угодно, и они ничего не пишут в буфер.
+     */
+    class NewsRingFormat {
+    public:
+        enum {
+            MAGIC = 0x524E5046,                 /**< Сигнатура буфера ("FPNR") */
+            VERSION = 1,                        /**< Версия формата буфера */
+            HEADER_SIZE = 128,                  /**< Размер заголовка */
+            SLOT_SIZE = 256,                    /**< Размер слота */
+            NAME_SIZE = 160,                    /**< Максимальная длина имени новости вместе с нулем */
+            CURRENCY_SIZE = 8,                  /**< Максимальная длина валюты вместе с нулем */
+            COUNTRY_SIZE = 40,                  /**< Максимальная длина страны вместе с нулем */
+            FLAG_PREVIOUS = 0x01,
+            FLAG_ACTUAL = 0x02,
+            FLAG_FORECAST = 0x04,
+            DEFAULT_CAPACITY = 4096,            /**< Количество слотов по умолчанию */
+        };
+
+        /** \brief Заголовок буфера
+         */
+        class Header {
+        public:
+            std::atomic<uint32_t> magic;        /**< Сигнатура, записывается последней при создании буфера */
+            uint32_t version;
+            uint64_t capacity;                  /**< Количество слотов, степень двойки */
+            uint8_t reserved[48];
+            std::atomic<uint64_t> write_pos;    /**< Количество опубликованных сообщений */
+            uint8_t reserved2[56];
+        };
+
+        /** \brief Данные новости в слоте
+         */
+        class Record {
+        public:
+            uint64_t timestamp;
+            double previous;
+            double actual;
+            double forecast;
+            int32_t level_volatility;
+            uint32_t flags;
+            char currency[CURRENCY_SIZE];
+            char country[COUNTRY_SIZE];
+            char name[NAME_SIZE];
+
+            /** \brief Заполнить запись из новости
+             *
+             * Слишком длинные строки обрезаются.
+             * \param news Новость
+             */
+            void set(const News &news) {
+                timestamp = news.timestamp;
+                previous = news.previous;
+                actual = news.actual;
+                forecast = news.forecast;
+                level_volatility = news.level_volatility;
+                flags = 0;
+                if(news.is_previous) flags |= FLAG_PREVIOUS;
+                if(news.is_actual) flags |= FLAG_ACTUAL;
+                if(news.is_forecast) flags |= FLAG_FORECAST;
+                copy_str(currency, sizeof(currency), news.currency);
+                copy_str(country, sizeof(country), news.country);
+                copy_str(name, sizeof(name), news.name);
+            }
+
+            /** \brief Получить новость из записи
+             * \param news Новость
+             */
+            void get(News &news) const {
+                news.timestamp = timestamp;
+                news.previous = previous;
+                news.actual = actual;
+                news.forecast = forecast;
+                news.level_volatility = level_volatility;
+                news.is_previous = (flags & FLAG_PREVIOUS) != 0;
+                news.is_actual = (flags & FLAG_ACTUAL) != 0;
+                news.is_forecast = (flags & FLAG_FORECAST) != 0;
+                news.currency.assign(currency, strnlen(currency, sizeof(currency)));
+                news.country.assign(country, strnlen(country, sizeof(country)));
+                news.name.assign(name, strnlen(name, sizeof(name)));
+            }
+
+        private:
+            static void copy_str(char *dst, const size_t size, const std::string &src) {
+                const size_t len = std::min(src.size(), size - 1);
+                std::memcpy(dst, src.data(), len);
+                std::memset(dst + len, 0, size - len);
+            }
+        };
+
+        /** \brief Слот буфера
+         */
+        class Slot {
+        public:
+            std::atomic<uint64_t> sequence;     /**< Счетчик последовательности */
+            Record record;                      /**< Данные новости */
+        };
+
+        /** \brief Получить размер буфера
+         * \param capacity Количество слотов
+         * \return Размер буфера в байтах
+         */
+        static size_t get_size(const uint64_t capacity) {
+            return (size_t)HEADER_SIZE + (size_t)capacity * SLOT_SIZE;
+        }
+
+        /** \brief Получить имя объекта общей памяти
+         * \param name Имя буфера
+         * \return Имя объекта общей памяти для shm_open или CreateFileMapping
+         */
+        static std::string get_shm_name(const std::string &name) {
+#           if defined(_WIN32)
+            return "Local\\" + name;
+#           else
+            return "/" + name;
+#           endif
+        }
+    };
+
+    /** \brief Общая память кольцевого буфера новостей
+     */
+    class NewsRingMemory {
+    protected:
+        uint8_t *data_ = nullptr;
+        size_t size_ = 0;
+#       if defined(_WIN32)
+        HANDLE mapping_handle_ = NULL;
+#       else
+        int fd_ = -1;
+#       endif
+
+        NewsRingMemory(const NewsRingMemory&) = delete;
+        NewsRingMemory& operator=(const NewsRingMemory&) = delete;
+
+        NewsRingFormat::Header *get_header() const {
+            return reinterpret_cast<NewsRingFormat::Header*>(data_);
+        }
+
+        NewsRingFormat::Slot *get_slot(const uint64_t pos) const {
+            const uint64_t capacity = get_header()->capacity;
+            return reinterpret_cast<NewsRingFormat::Slot*>(
+                data_ + NewsRingFormat::HEADER_SIZE + (size_t)(pos & (capacity - 1)) * NewsRingFormat::SLOT_SIZE);
+        }
+
+        /** \brief Проверить заголовок буфера
+         * \return Вернет true, если заголовок заполнен и размер буфера ему соответствует
+         */
+        bool check_header() const {
+            typedef NewsRingFormat F;
+            if(size_ < F::HEADER_SIZE) return false;
+            const F::Header *header = get_header();
+            if(header->magic.load(std::memory_order_acquire) != (uint32_t)F::MAGIC) return false;
+            if(header->version != (uint32_t)F::VERSION) return false;
+            if(header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0) return false;
+            return size_ >= F::get_size(header->capacity);
+        }
+
+    public:
+
+        NewsRingMemory() {
+            static_assert(sizeof(NewsRingFormat::Header) == NewsRingFormat::HEADER_SIZE, "NewsRingFormat::Header size");
+            static_assert(sizeof(NewsRingFormat::Slot) == NewsRingFormat::SLOT_SIZE, "NewsRingFormat::Slot size");
+            static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "NewsRingFormat requires lock-free 64-bit atomics");
+        };
+
+        ~NewsRingMemory() {
+            close();
+        }
+
+        /** \brief Закрыть буфер
+         *
+         * Объект общей памяти не удаляется, см. NewsRingPublisher::remove
+         */
+        void close() {
+#           if defined(_WIN32)
+            if(data_ != nullptr) UnmapViewOfFile(data_);
+            if(mapping_handle_ != NULL) CloseHandle(mapping_handle_);
+            mapping_handle_ = NULL;
+#           else
+            if(data_ != nullptr) munmap(data_, size_);
+            if(fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+#           endif
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+        /** \brief Проверить, открыт ли буфер
+         * \return Вернет true, если буфер открыт
+         */
+        bool is_open() const {
+            return data_ != nullptr;
+        }
+
+        /** \brief Получить количество слотов
+         * \return Количество слотов или 0, если буфер не открыт
+         */
+        uint64_t get_capacity() const {
+            if(!is_open()) return 0;
+            return get_header()->capacity;
+        }
+    };
+
+    /** \brief Писатель кольцевого буфера новостей
+     *
+     * Публикует обновления новостей в общую память, откуда их читают процессы с NewsRingSubscriber.
+     * Писатель должен быть один. Публикация не блокируется медленными читателями:
+     * если читатель отстал больше чем на размер буфера, он пропустит старые сообщения.
+     */
+    class NewsRingPublisher : public NewsRingMemory {
+    public:
+
+        NewsRingPublisher() {};
+
+        /** \brief Создать или открыть буфер
+         *
+         * Если буфер с таким именем уже существует и имеет то же количество слотов,
+         * публикация продолжается с его текущей позиции, поэтому подключенные читатели
+         * не теряют очередь при перезапуске писателя. Буфер с другим количеством слотов
+         * не изменяется, так как его могут использовать читатели: метод вернет INVALID_PARAMETER,
+         * и буфер нужно удалить методом remove после того, как читатели его закроют.
+         * \param name Имя буфера
+         * \param capacity Количество слотов, округляется вверх до степени двойки
+         * \return Вернет 0 в случае успеха
+         */
+        int open(const std::string &name, uint64_t capacity = NewsRingFormat::DEFAULT_CAPACITY) {
+            typedef NewsRingFormat F;
+            close();
+            if(name.empty() || capacity == 0) return INVALID_PARAMETER;
+            uint64_t round_capacity = 1;
+            while(round_capacity < capacity) round_capacity <<= 1;
+            capacity = round_capacity;
+            const size_t size = F::get_size(capacity);
+            const std::string shm_name = F::get_shm_name(name);
+#           if defined(_WIN32)
+            mapping_handle_ = CreateFileMappingA(
+                INVALID_HANDLE_VALUE,
+                NULL,
+                PAGE_READWRITE,
+                (DWORD)((uint64_t)size >> 32),
+                (DWORD)((uint64_t)size & 0xFFFFFFFF),
+                shm_name.c_str());
+            if(mapping_handle_ == NULL) return NO_DATA_ACCESS;
+            const bool is_exist = GetLastError() == ERROR_ALREADY_EXISTS;
+            data_ = static_cast<uint8_t*>(MapViewOfFile(mapping_handle_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+            /* существующий буфер меньшего размера */
+            if(data_ == nullptr && is_exist) {
+                close();
+                return INVALID_PARAMETER;
+            }
+#           else
+            fd_ = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0644);
+            if(fd_ < 0) return NO_DATA_ACCESS;
+            struct stat st;
+            if(fstat(fd_, &st) != 0) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            /* размер задается только новому буферу, буфер другого размера могут использовать читатели */
+            if(st.st_size != 0 && (size_t)st.st_size != size) {
+                close();
+                return INVALID_PARAMETER;
+            }
+            if(st.st_size == 0 && ftruncate(fd_, (off_t)size) != 0) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if(ptr == MAP_FAILED) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            data_ = static_cast<uint8_t*>(ptr);
+#           endif
+            if(data_ == nullptr) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            size_ = size;
+            if(check_header()) {
+                if(get_header()->capacity == capacity) return OK;
+                close();
+                return INVALID_PARAMETER;
+            }
+
+            /* новый буфер или буфер, заголовок которого не был дописан: читатели увидят его только после записи сигнатуры */
+            F::Header *header = get_header();
+            header->magic.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            header->version = F::VERSION;
+            header->capacity = capacity;
+            std::memset(header->reserved, 0, sizeof(header->reserved));
+            std::memset(header->reserved2, 0, sizeof(header->reserved2));
+            header->write_pos.store(0, std::memory_order_relaxed);
+            for(uint64_t i = 0; i < capacity; ++i) {
+                get_slot(i)->sequence.store(0, std::memory_order_relaxed);
+            }
+            header->magic.store(F::MAGIC, std::memory_order_release);
+            return OK;
+        }
+
+        /** \brief Опубликовать новость
+         * \param news Новость
+         * \return Вернет 0 в случае успеха
+         */
+        int publish(const News &news) {
+            if(!is_open()) return NO_DATA_ACCESS;
+            NewsRingFormat::Header *header = get_header();
+            const uint64_t pos = header->write_pos.load(std::memory_order_relaxed);
+            NewsRingFormat::Slot *slot = get_slot(pos);
+            slot->sequence.store(2 * pos + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot->record.set(news);
+            slot->sequence.store(2 * pos + 2, std::memory_order_release);
+            header->write_pos.store(pos + 1, std::memory_order_release);
+            return OK;
+        }
+
+        /** \brief Опубликовать список новостей
+         * \param list_news Список новостей
+         * \return Вернет 0 в случае успеха
+         */
+        int publish(const std::vector<News> &list_news) {
+            for(size_t i = 0; i < list_news.size(); ++i) {
+                int err = publish(list_news[i]);
+                if(err != OK) return err;
+            }
+            return OK;
+        }
+
+        /** \brief Удалить объект общей памяти
+         *
+         * На Windows объект удаляется сам, когда закрыт последний обработчик.
+         * \param name Имя буфера
+         */
+        static void remove(const std::string &name) {
+#           if !defined(_WIN32)
+            shm_unlink(NewsRingFormat::get_shm_name(name).c_str());
+#           endif
+        }
+    };
+
+    /** \brief Читатель кольцевого буфера новостей
+     *
+     * Читатель только отображает буфер в память и ничего в него не пишет,
+     * поэтому читатели не мешают друг другу и писателю. Метод read не блокируется:
+     * если новых сообщений нет, он сразу возвращает false.
+     */
+    class NewsRingSubscriber : public NewsRingMemory {
+    private:
+        uint64_t read_pos_ = 0;     /**< Номер следующего сообщения */
+        uint64_t num_lost_ = 0;     /**< Количество пропущенных сообщений */
+
+    public:
+
+        NewsRingSubscriber() {};
+
+        /** \brief Открыть буфер
+         * \param name Имя буфера
+         * \param is_from_begin Если true, сначала будут прочитаны все сообщения, которые еще есть в буфере.
+         * Иначе будут прочитаны только сообщения, опубликованные после открытия
+         * \return Вернет 0 в случае успеха
+         */
+        int open(const std::string &name, const bool is_from_begin = false) {
+            typedef NewsRingFormat F;
+            close();
+            if(name.empty()) return INVALID_PARAMETER;
+            const std::string shm_name = F::get_shm_name(name);
+#           if defined(_WIN32)
+            mapping_handle_ = OpenFileMappingA(FILE_MAP_READ, FALSE, shm_name.c_str());
+            if(mapping_handle_ == NULL) return NO_DATA_ACCESS;
+            data_ = static_cast<uint8_t*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+            MEMORY_BASIC_INFORMATION info;
+            if(data_ != nullptr && VirtualQuery(data_, &info, sizeof(info)) != 0) size_ = info.RegionSize;
+#           else
+            fd_ = shm_open(shm_name.c_str(), O_RDONLY, 0);
+            if(fd_ < 0) return NO_DATA_ACCESS;
+            struct stat st;
+            if(fstat(fd_, &st) != 0 || st.st_size < F::HEADER_SIZE) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            void *ptr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd_, 0);
+            if(ptr == MAP_FAILED) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            data_ = static_cast<uint8_t*>(ptr);
+            size_ = (size_t)st.st_size;
+#           endif
+            if(data_ == nullptr || !check_header()) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            const uint64_t write_pos = get_header()->write_pos.load(std::memory_order_acquire);
+            const uint64_t capacity = get_header()->capacity;
+            read_pos_ = write_pos;
+            if(is_from_begin) read_pos_ = write_pos > capacity ? write_pos - capacity : 0;
+            num_lost_ = 0;
+            return OK;
+        }
+
+        /** \brief Прочитать следующую новость
+         * \param news Новость
+         * \return Вернет true, если новость прочитана, и false, если новых сообщений нет
+         */
+        bool read(News &news) {
+            if(!is_open()) return false;
+            const NewsRingFormat::Header *header = get_header();
+            const uint64_t capacity = header->capacity;
+            NewsRingFormat::Record record;
+            while(true) {
+                const uint64_t write_pos = header->write_pos.load(std::memory_order_acquire);
+                if(read_pos_ >= write_pos) return false;
+                /* писатель обогнал читателя на весь буфер */
+                if(write_pos - read_pos_ > capacity) {
+                    num_lost_ += write_pos - capacity - read_pos_;
+                    read_pos_ = write_pos - capacity;
+                }
+                const NewsRingFormat::Slot *slot = get_slot(read_pos_);
+                const uint64_t expected = 2 * read_pos_ + 2;
+                const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+                if(sequence != expected) {
+                    /* слот уже перезаписывается более новым сообщением */
+                    ++num_lost_;
+                    ++read_pos_;
+                    continue;
+                }
+                std::memcpy(&record, &slot->record, sizeof(record));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(slot->sequence.load(std::memory_order_relaxed) != expected) {
+                    ++num_lost_;
+                    ++read_pos_;
+                    continue;
+                }
+                ++read_pos_;
+                record.get(news);
+                return true;
+            }
+        }
+
+        /** \brief Прочитать все новые новости
+         * \param list_news Список новостей, новости добавляются в конец
+         * \return Количество прочитанных новостей
+         */
+        size_t read(std::vector<News> &list_news) {
+            size_t num = 0;
+            News news;
+            while(read(news)) {
+                list_news.push_back(news);
+                ++num;
+            }
+            return num;
+        }
+
+        /** \brief Получить количество пропущенных сообщений
+         *
+         * Сообщения пропускаются, если читатель отстал от писателя больше чем на размер буфера.
+         * \return Количество пропущенных сообщений с момента открытия буфера
+         */
+        uint64_t get_num_lost() const {
+            return num_lost_;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_NEWS_RING_HPP_INCLUDED
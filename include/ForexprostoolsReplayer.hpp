@@ -0,0 +1,321 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_REPLAYER_HPP_INCLUDED
+#define FOREXPROSTOOLS_REPLAYER_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsDataStore.hpp>
+#include <deque>
+#include <limits>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsDataStore {
+
+    /** \brief Воспроизведение новостей хранилища для тестирования стратегий
+     *
+     * Новости выдаются по одной в порядке возрастания метки времени, каждая ровно один раз.
+     * Новости с одинаковой меткой времени выдаются в порядке хранения, поэтому повторное
+     * воспроизведение дает ту же последовательность. Дни заранее читаются и декодируются
+     * в фоновом потоке блоками, пока пользователь обрабатывает уже загруженные новости.
+     * Воспроизведение открывает хранилище отдельно, поэтому не мешает другим объектам DataStore.
+     *
+     * Новости можно получать по одной (next, peek), например, чтобы чередовать их с котировками,
+     * или через функцию обратного вызова (replay).
+     */
+    class NewsReplayer {
+    public:
+        /// Функция обратного вызова воспроизведения, вернет false, чтобы остановить воспроизведение
+        typedef std::function<bool(const News &news)> replay_callback_t;
+
+    private:
+        DataStore store_;
+        NewsPredicate predicate_;
+        bool is_predicate_ = false;
+        xtime::timestamp_t beg_timestamp_ = 0;
+        xtime::timestamp_t end_timestamp_ = 0;
+        std::vector<xtime::timestamp_t> list_days_;     /**< Дни с новостями в периоде воспроизведения */
+        size_t max_blocks_ = 4;                         /**< Максимальное количество заранее загруженных блоков */
+
+        std::thread prefetch_thread_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::vector<News>> blocks_;          /**< Загруженные блоки новостей */
+        bool is_stop_ = false;                          /**< Флаг остановки фонового потока */
+        bool is_done_ = false;                          /**< Фоновый поток загрузил все дни */
+        bool is_start_ = false;                         /**< Флаг запуска фонового потока */
+        int err_ = OK;                                  /**< Код первой ошибки чтения дня */
+
+        std::vector<News> current_;                     /**< Текущий блок новостей */
+        size_t current_index_ = 0;                      /**< Номер следующей новости текущего блока */
+
+        const size_t BLOCK_DAYS = 16;                   /**< Количество дней в одном блоке */
+
+        /** \brief Цикл фоновой загрузки дней
+         */
+        void prefetch_loop() {
+            std::vector<xtime::timestamp_t> block_days;
+            std::vector<std::vector<News>> days_news;
+            std::vector<int> list_err;
+            for(size_t index = 0; index < list_days_.size(); index += BLOCK_DAYS) {
+                /* блоки могут целиком отсеиваться условием, поэтому остановка проверяется на каждом блоке */
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if(is_stop_) return;
+                }
+                block_days.assign(
+                    list_days_.begin() + index,
+                    list_days_.begin() + std::min(index + BLOCK_DAYS, list_days_.size()));
+                store_.read_news(block_days, days_news, list_err);
+
+                std::vector<News> block;
+                for(size_t d = 0; d < block_days.size(); ++d) {
+                    if(list_err[d] != OK) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if(err_ == OK) err_ = list_err[d];
+                        continue;
+                    }
+                    std::vector<News> &list_news = days_news[d];
+                    std::stable_sort(list_news.begin(), list_news.end(), [](const News &lhs, const News &rhs) {
+                        return lhs.timestamp < rhs.timestamp;
+                    });
+                    for(size_t i = 0; i < list_news.size(); ++i) {
+                        const News &news = list_news[i];
+                        if(news.timestamp < beg_timestamp_ || news.timestamp > end_timestamp_) continue;
+                        if(is_predicate_ && !predicate_.check(news)) continue;
+                        block.push_back(std::move(list_news[i]));
+                    }
+                }
+                if(block.empty()) continue;
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] {
+                    return is_stop_ || blocks_.size() < max_blocks_;
+                });
+                if(is_stop_) return;
+                blocks_.push_back(std::move(block));
+                cv_.notify_all();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            is_done_ = true;
+            cv_.notify_all();
+        }
+
+        /** \brief Перейти к следующему загруженному блоку
+         * \return Вернет false, если новостей больше нет
+         */
+        bool load_block() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] {
+                return is_stop_ || is_done_ || !blocks_.empty();
+            });
+            if(blocks_.empty()) return false;
+            current_.swap(blocks_.front());
+            blocks_.pop_front();
+            current_index_ = 0;
+            cv_.notify_all();
+            return true;
+        }
+
+        /** \brief Запустить фоновую загрузку дней периода
+         * \param beg_timestamp Метка времени начала воспроизведения
+         * \param end_timestamp Метка времени конца воспроизведения (включительно)
+         * \return Вернет 0 в случае успеха
+         */
+        int start_prefetch(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp) {
+            if(beg_timestamp > end_timestamp) return INVALID_PARAMETER;
+            xtime::timestamp_t min_timestamp = 0, max_timestamp = 0;
+            if(store_.get_min_max_timestamp(min_timestamp, max_timestamp) != OK) return NO_DATA_ACCESS;
+            beg_timestamp_ = beg_timestamp;
+            end_timestamp_ = end_timestamp;
+            list_days_.clear();
+            const xtime::timestamp_t start_timestamp = std::max(xtime::get_first_timestamp_day(beg_timestamp), min_timestamp);
+            const xtime::timestamp_t stop_timestamp = std::min(xtime::get_first_timestamp_day(end_timestamp), max_timestamp);
+            for(xtime::timestamp_t t = start_timestamp; t <= stop_timestamp; t += xtime::SECONDS_IN_DAY) {
+                if(store_.check_timestamp(t)) list_days_.push_back(t);
+            }
+            if(list_days_.empty()) return NO_DATA_ACCESS;
+
+            current_.clear();
+            current_index_ = 0;
+            blocks_.clear();
+            is_stop_ = false;
+            is_done_ = false;
+            err_ = OK;
+            prefetch_thread_ = std::thread(&NewsReplayer::prefetch_loop, this);
+            is_start_ = true;
+            return OK;
+        }
+
+        int replay_loop(replay_callback_t &callback) {
+            while(true) {
+                const News *news = next();
+                if(news == NULL) break;
+                if(!callback(*news)) break;
+            }
+            const int err = get_error();
+            stop();
+            return err;
+        }
+
+    public:
+
+        /** \brief Инициализировать воспроизведение новостей
+         * \param path Путь к хранилищу
+         * \param prefetch_days Сколько дней загружать заранее
+         * \param read_threads Количество потоков чтения дней (см. DataStore::set_read_threads)
+         */
+        NewsReplayer(
+                const std::string &path,
+                const uint32_t prefetch_days = 64,
+                const uint32_t read_threads = 1) :
+                store_(path) {
+            max_blocks_ = std::max((size_t)2, (size_t)prefetch_days / BLOCK_DAYS);
+            store_.set_read_threads(read_threads);
+        }
+
+        ~NewsReplayer() {
+            stop();
+        }
+
+        /** \brief Начать воспроизведение
+         * \param beg_timestamp Метка времени начала воспроизведения
+         * \param end_timestamp Метка времени конца воспроизведения (включительно)
+         * \return Вернет 0 в случае успеха или NO_DATA_ACCESS, если за период нет новостей
+         */
+        int start(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp = std::numeric_limits<xtime::timestamp_t>::max()) {
+            stop();
+            is_predicate_ = false;
+            return start_prefetch(beg_timestamp, end_timestamp);
+        }
+
+        /** \brief Начать воспроизведение с условием отбора новостей
+         * \param beg_timestamp Метка времени начала воспроизведения
+         * \param end_timestamp Метка времени конца воспроизведения (включительно)
+         * \param predicate Условие отбора новостей
+         * \return Вернет 0 в случае успеха или NO_DATA_ACCESS, если за период нет новостей
+         */
+        int start(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const NewsPredicate &predicate) {
+            stop();
+            predicate_ = predicate;
+            is_predicate_ = true;
+            return start_prefetch(beg_timestamp, end_timestamp);
+        }
+
+        /** \brief Остановить воспроизведение
+         */
+        void stop() {
+            if(!is_start_) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                is_stop_ = true;
+            }
+            cv_.notify_all();
+            prefetch_thread_.join();
+            is_start_ = false;
+            blocks_.clear();
+            current_.clear();
+            current_index_ = 0;
+        }
+
+        /** \brief Посмотреть следующую новость, не забирая ее
+         * \return Указатель на новость или NULL, если новостей больше нет. Указатель действителен до вызова next
+         */
+        const News *peek() {
+            if(!is_start_) return NULL;
+            while(current_index_ >= current_.size()) {
+                if(!load_block()) return NULL;
+            }
+            return &current_[current_index_];
+        }
+
+        /** \brief Получить следующую новость
+         * \return Указатель на новость или NULL, если новостей больше нет. Указатель действителен до следующего вызова next
+         */
+        const News *next() {
+            const News *news = peek();
+            if(news != NULL) ++current_index_;
+            return news;
+        }
+
+        /** \brief Получить следующую новость
+         * \param news Новость
+         * \return Вернет true, если новость получена, или false, если новостей больше нет
+         */
+        bool next(News &news) {
+            const News *next_news = next();
+            if(next_news == NULL) return false;
+            news = *next_news;
+            return true;
+        }
+
+        /** \brief Получить код ошибки чтения
+         * \return Код первой ошибки чтения дня. Дни, которые не удалось прочитать, пропускаются
+         */
+        int get_error() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return err_;
+        }
+
+        /** \brief Воспроизвести новости через функцию обратного вызова
+         *
+         * Функция обратного вызова вызывается из потока, вызвавшего replay.
+         * \param beg_timestamp Метка времени начала воспроизведения
+         * \param end_timestamp Метка времени конца воспроизведения (включительно)
+         * \param callback Функция обратного вызова, вернет false, чтобы остановить воспроизведение
+         * \return Вернет 0 в случае успеха
+         */
+        int replay(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                replay_callback_t callback) {
+            int err = start(beg_timestamp, end_timestamp);
+            if(err != OK) return err;
+            return replay_loop(callback);
+        }
+
+        /** \brief Воспроизвести новости с условием отбора через функцию обратного вызова
+         * \param beg_timestamp Метка времени начала воспроизведения
+         * \param end_timestamp Метка времени конца воспроизведения (включительно)
+         * \param predicate Условие отбора новостей
+         * \param callback Функция обратного вызова, вернет false, чтобы остановить воспроизведение
+         * \return Вернет 0 в случае успеха
+         */
+        int replay(
+                const xtime::timestamp_t beg_timestamp,
+                const xtime::timestamp_t end_timestamp,
+                const NewsPredicate &predicate,
+                replay_callback_t callback) {
+            int err = start(beg_timestamp, end_timestamp, predicate);
+            if(err != OK) return err;
+            return replay_loop(callback);
+        }
+
+    };
+}
+#endif // FOREXPROSTOOLS_REPLAYER_HPP_INCLUDED
@@ -0,0 +1,204 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_RESPONSE_CACHE_HPP_INCLUDED
+#define FOREXPROSTOOLS_RESPONSE_CACHE_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <fstream>
+#include <cstdio>
+#include <cinttypes>
+#include <atomic>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsResponseCache {
+
+    /** \brief Дисковый кэш ответов сервера
+     *
+     * Кэш хранит сжатые ответы сервера в том виде, в котором они были получены.
+     * Ключом служит тело запроса. Новости за давно прошедшие дни на сервере уже не меняются,
+     * поэтому такие ответы считаются неизменяемыми и читаются из кэша всегда.
+     * Ответы за последние дни считаются свежими только в течение max_age секунд.
+     */
+    class ResponseCache {
+    private:
+        std::string path_;                          /**< Директория кэша */
+        uint32_t immutable_days_ = 30;              /**< Возраст дня, после которого ответ считается неизменяемым */
+        xtime::timestamp_t max_age_ = 0;            /**< Время жизни ответа за недавние дни */
+        bool is_use_ = false;                       /**< Флаг использования кэша */
+
+        enum {
+            MAGIC = 0x43525046,                     /**< Сигнатура файла кэша ("FPRC") */
+        };
+
+        /** \brief Получить имя файла кэша
+         * \param request_body Тело запроса
+         * \return Имя файла кэша
+         */
+        std::string get_file_name(const std::string &request_body) const {
+            char str_hash[32];
+            std::snprintf(str_hash, sizeof(str_hash), "%016" PRIx64, ForexprostoolsApiEasy::get_hash(request_body));
+            return path_ + "//" + std::string(str_hash) + ".gz";
+        }
+
+        /** \brief Получить имя временного файла для записи ответа
+         *
+         * Ответ может записываться одновременно из потока асинхронных запросов,
+         * из синхронного get_response и из других процессов, поэтому имя содержит
+         * идентификатор процесса и номер записи.
+         * \param file_name Имя файла кэша
+         * \return Имя временного файла
+         */
+        static std::string get_tmp_file_name(const std::string &file_name) {
+            static std::atomic<uint32_t> counter(0);
+#           if defined(_WIN32)
+            const long pid = _getpid();
+#           else
+            const long pid = getpid();
+#           endif
+            return file_name + "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+        }
+
+        template<class T>
+        static bool read_value(std::ifstream &file, T &value) {
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return (bool)file;
+        }
+
+        template<class T>
+        static void write_value(std::ofstream &file, const T &value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+    public:
+
+        ResponseCache() {};
+
+        /** \brief Включить кэш ответов
+         * \param path Директория кэша
+         * \param immutable_days Возраст дня (в днях на момент загрузки), начиная с которого ответ больше не меняется
+         * \param max_age Время жизни ответа за недавние дни в секундах. Если 0, такие ответы из кэша не читаются
+         */
+        void set(
+                const std::string &path,
+                const uint32_t immutable_days = 30,
+                const xtime::timestamp_t max_age = 0) {
+            path_ = path;
+            immutable_days_ = immutable_days;
+            max_age_ = max_age;
+            is_use_ = path_.size() > 0;
+            if(is_use_) bf::create_directory(path_);
+        }
+
+        /** \brief Отключить кэш ответов
+         */
+        void reset() {
+            is_use_ = false;
+        }
+
+        /** \brief Проверить, включен ли кэш
+         * \return Вернет true, если кэш используется
+         */
+        bool is_use() const {
+            return is_use_;
+        }
+
+        /** \brief Прочитать ответ из кэша
+         * \param request_body Тело запроса
+         * \param out Сжатый ответ сервера
+         * \return Вернет true, если в кэше есть свежий ответ
+         */
+        bool get(const std::string &request_body, std::string &out) const {
+            if(!is_use_) return false;
+            std::ifstream file(get_file_name(request_body), std::ios::binary);
+            if(!file) return false;
+            uint32_t magic = 0, body_size = 0;
+            if(!read_value(file, magic) || magic != MAGIC) return false;
+            if(!read_value(file, body_size) || body_size != request_body.size()) return false;
+            std::string body(body_size, '\0');
+            if(!file.read(&body[0], body_size) || body != request_body) return false;
+            xtime::timestamp_t write_timestamp = 0, end_timestamp = 0;
+            uint64_t data_size = 0;
+            if(!read_value(file, write_timestamp) ||
+                !read_value(file, end_timestamp) ||
+                !read_value(file, data_size)) return false;
+
+            /* проверяем свежесть ответа */
+            const xtime::timestamp_t immutable_age = (xtime::timestamp_t)immutable_days_ * xtime::SECONDS_IN_DAY;
+            const bool is_immutable = write_timestamp >= end_timestamp &&
+                (write_timestamp - end_timestamp) >= immutable_age;
+            if(!is_immutable) {
+                const xtime::timestamp_t timestamp = xtime::get_timestamp();
+                if(max_age_ == 0 || timestamp < write_timestamp || (timestamp - write_timestamp) > max_age_) return false;
+            }
+            out.resize(data_size);
+            if(data_size > 0 && !file.read(&out[0], data_size)) {
+                out.clear();
+                return false;
+            }
+            return true;
+        }
+
+        /** \brief Записать ответ в кэш
+         * \param request_body Тело запроса
+         * \param end_timestamp Метка времени конца периода запроса
+         * \param data Сжатый ответ сервера
+         * \return Вернет true в случае успеха
+         */
+        bool put(
+                const std::string &request_body,
+                const xtime::timestamp_t end_timestamp,
+                const std::string &data) const {
+            if(!is_use_) return false;
+            const std::string file_name = get_file_name(request_body);
+            const std::string tmp_file_name = get_tmp_file_name(file_name);
+            {
+                std::ofstream file(tmp_file_name, std::ios::binary | std::ios::trunc);
+                if(!file) return false;
+                write_value(file, (uint32_t)MAGIC);
+                write_value(file, (uint32_t)request_body.size());
+                file.write(request_body.data(), request_body.size());
+                write_value(file, xtime::get_timestamp());
+                write_value(file, end_timestamp);
+                write_value(file, (uint64_t)data.size());
+                file.write(data.data(), data.size());
+                if(!file) {
+                    file.close();
+                    std::remove(tmp_file_name.c_str());
+                    return false;
+                }
+            }
+            /* заменяем файл целиком, чтобы не оставить в кэше половину ответа */
+            if(!ForexprostoolsApiEasy::replace_file(tmp_file_name, file_name)) {
+                std::remove(tmp_file_name.c_str());
+                return false;
+            }
+            return true;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_RESPONSE_CACHE_HPP_INCLUDED
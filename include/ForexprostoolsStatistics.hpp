@@ -0,0 +1,87 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_STATISTICS_HPP_INCLUDED
+#define FOREXPROSTOOLS_STATISTICS_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <map>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /** \brief Статистика новостей
+     *
+     * Частичные статистики, посчитанные в разных потоках, объединяются методом merge.
+     */
+    class NewsStatistics {
+    public:
+        uint64_t num_news = 0;                          /**< Количество новостей */
+        uint64_t num_days = 0;                          /**< Количество дней */
+        uint64_t num_previous = 0;                      /**< Количество новостей с предыдущим значением */
+        uint64_t num_actual = 0;                        /**< Количество новостей с актуальным значением */
+        uint64_t num_forecast = 0;                      /**< Количество новостей с предсказанным значением */
+        std::map<std::string, uint64_t> names;          /**< Количество новостей по именам */
+        std::map<std::string, uint64_t> currencies;     /**< Количество новостей по валютам */
+        std::map<int, uint64_t> volatility;             /**< Количество новостей по уровням силы */
+        std::map<int, uint64_t> years;                  /**< Количество новостей по годам */
+
+        NewsStatistics() {};
+
+        /** \brief Добавить новости дня
+         * \param timestamp Метка времени дня
+         * \param list_news Новости дня
+         */
+        void add(const xtime::timestamp_t timestamp, const std::vector<News> &list_news) {
+            ++num_days;
+            if(list_news.empty()) return;
+            const int year = xtime::DateTime(timestamp).year;
+            years[year] += list_news.size();
+            num_news += list_news.size();
+            for(size_t i = 0; i < list_news.size(); ++i) {
+                const News &news = list_news[i];
+                ++names[news.name];
+                ++currencies[news.currency];
+                ++volatility[news.level_volatility];
+                if(news.is_previous) ++num_previous;
+                if(news.is_actual) ++num_actual;
+                if(news.is_forecast) ++num_forecast;
+            }
+        }
+
+        /** \brief Объединить статистики
+         * \param other Частичная статистика
+         */
+        void merge(const NewsStatistics &other) {
+            num_news += other.num_news;
+            num_days += other.num_days;
+            num_previous += other.num_previous;
+            num_actual += other.num_actual;
+            num_forecast += other.num_forecast;
+            for(auto it = other.names.begin(); it != other.names.end(); ++it) names[it->first] += it->second;
+            for(auto it = other.currencies.begin(); it != other.currencies.end(); ++it) currencies[it->first] += it->second;
+            for(auto it = other.volatility.begin(); it != other.volatility.end(); ++it) volatility[it->first] += it->second;
+            for(auto it = other.years.begin(); it != other.years.end(); ++it) years[it->first] += it->second;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_STATISTICS_HPP_INCLUDED
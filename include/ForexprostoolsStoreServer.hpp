@@ -0,0 +1,1093 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_STORE_SERVER_HPP_INCLUDED
+#define FOREXPROSTOOLS_STORE_SERVER_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsDataStore.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsDataStore {
+
+    /** \brief Бинарный протокол сервера хранилища
+     *
+     * Кадр начинается с заголовка (сигнатура, размер тела, количество запросов или ответов),
+     * за которым идут запросы или ответы подряд. В одном кадре можно передать сразу много запросов,
+     * ответы приходят одним кадром в том же порядке. Числа передаются в порядке байтов процессора,
+     * так как сервер и клиенты работают на одном компьютере.
+     * Тело кадра не больше MAX_FRAME_SIZE. Если ответ на запрос не помещается в кадр ответов,
+     * вместо него сервер вернет код INVALID_PARAMETER без данных.
+     */
+    class StoreProtocol {
+    public:
+        enum {
+            MAGIC = 0x51535046,                 /**< Сигнатура кадра ("FPSQ") */
+            FRAME_HEADER_SIZE = 12,             /**< Размер заголовка кадра */
+            MAX_FRAME_SIZE = 64 * 1024 * 1024,  /**< Максимальный размер тела кадра */
+        };
+
+        /// Команды запросов
+        enum CommandType {
+            CMD_GET = 1,                        ///< DataStore::get за окно вокруг метки времени
+            CMD_FILTER = 2,                     ///< DataStore::filter для валютной пары
+            CMD_NEXT_EVENT = 3,                 ///< DataStore::next_event
+            CMD_PREV_EVENT = 4,                 ///< DataStore::prev_event
+            CMD_MIN_MAX = 5,                    ///< DataStore::get_min_max_timestamp
+        };
+
+        /// Флаги фильтра
+        enum {
+            FLAG_ONLY_SELECT = 0x01,
+            FLAG_LOW = 0x02,
+            FLAG_MODERATE = 0x04,
+            FLAG_HIGH = 0x08,
+        };
+
+        /// Флаги значений новости
+        enum {
+            NEWS_PREVIOUS = 0x01,
+            NEWS_ACTUAL = 0x02,
+            NEWS_FORECAST = 0x04,
+        };
+
+        /** \brief Запись данных в кадр
+         */
+        class Writer {
+        private:
+            std::string &buffer_;
+        public:
+            Writer(std::string &buffer) : buffer_(buffer) {};
+
+            template<class T>
+            void write(const T &value) {
+                buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            void write_str(const std::string &str) {
+                const uint16_t len = (uint16_t)std::min(str.size(), (size_t)0xFFFF);
+                write(len);
+                buffer_.append(str.data(), len);
+            }
+
+            void write_news(const News &news) {
+                uint8_t flags = 0;
+                if(news.is_previous) flags |= NEWS_PREVIOUS;
+                if(news.is_actual) flags |= NEWS_ACTUAL;
+                if(news.is_forecast) flags |= NEWS_FORECAST;
+                write((uint64_t)news.timestamp);
+                write(news.previous);
+                write(news.actual);
+                write(news.forecast);
+                write((int8_t)news.level_volatility);
+                write(flags);
+                write_str(news.currency);
+                write_str(news.country);
+                write_str(news.name);
+            }
+        };
+
+        /** \brief Чтение данных из кадра
+         *
+         * Все методы проверяют границы кадра и вернут false, если данных не хватает.
+         */
+        class Reader {
+        private:
+            const char *data_;
+            size_t size_;
+            size_t pos_ = 0;
+        public:
+            Reader(const char *data, const size_t size) : data_(data), size_(size) {};
+
+            template<class T>
+            bool read(T &value) {
+                if(size_ - pos_ < sizeof(T)) return false;
+                std::memcpy(&value, data_ + pos_, sizeof(T));
+                pos_ += sizeof(T);
+                return true;
+            }
+
+            bool read_str(std::string &str) {
+                uint16_t len = 0;
+                if(!read(len) || size_ - pos_ < len) return false;
+                str.assign(data_ + pos_, len);
+                pos_ += len;
+                return true;
+            }
+
+            bool read_news(News &news) {
+                uint64_t timestamp = 0;
+                int8_t level_volatility = 0;
+                uint8_t flags = 0;
+                if(!read(timestamp) ||
+                    !read(news.previous) ||
+                    !read(news.actual) ||
+                    !read(news.forecast) ||
+                    !read(level_volatility) ||
+                    !read(flags) ||
+                    !read_str(news.currency) ||
+                    !read_str(news.country) ||
+                    !read_str(news.name)) return false;
+                news.timestamp = timestamp;
+                news.level_volatility = level_volatility;
+                news.is_previous = (flags & NEWS_PREVIOUS) != 0;
+                news.is_actual = (flags & NEWS_ACTUAL) != 0;
+                news.is_forecast = (flags & NEWS_FORECAST) != 0;
+                return true;
+            }
+
+            bool is_end() const {
+                return pos_ == size_;
+            }
+        };
+
+        /** \brief Начать кадр
+         * \param buffer Буфер кадра
+         */
+        static void begin_frame(std::string &buffer) {
+            buffer.assign(FRAME_HEADER_SIZE, '\0');
+        }
+
+        /** \brief Заполнить заголовок кадра
+         * \param buffer Буфер кадра
+         * \param count Количество запросов или ответов
+         */
+        static void end_frame(std::string &buffer, const uint32_t count) {
+            const uint32_t magic = MAGIC;
+            const uint32_t size = (uint32_t)(buffer.size() - FRAME_HEADER_SIZE);
+            std::memcpy(&buffer[0], &magic, sizeof(magic));
+            std::memcpy(&buffer[4], &size, sizeof(size));
+            std::memcpy(&buffer[8], &count, sizeof(count));
+        }
+
+        /** \brief Разобрать заголовок кадра
+         * \param data Данные заголовка размером FRAME_HEADER_SIZE
+         * \param size Размер тела кадра
+         * \param count Количество запросов или ответов
+         * \return Вернет true, если заголовок корректен
+         */
+        static bool parse_frame_header(const char *data, uint32_t &size, uint32_t &count) {
+            uint32_t magic = 0;
+            std::memcpy(&magic, data, sizeof(magic));
+            std::memcpy(&size, data + 4, sizeof(size));
+            std::memcpy(&count, data + 8, sizeof(count));
+            return magic == (uint32_t)MAGIC && size <= (uint32_t)MAX_FRAME_SIZE;
+        }
+    };
+
+    /** \brief Запрос к серверу хранилища
+     */
+    class StoreRequest {
+    public:
+        uint8_t command = 0;                        /**< Команда (StoreProtocol::CommandType) */
+        xtime::timestamp_t timestamp = 0;           /**< Метка времени */
+        xtime::timestamp_t indent_past = 0;         /**< Максимальный отступ до метки времени */
+        xtime::timestamp_t indent_future = 0;       /**< Максимальный отступ после метки времени */
+        std::string pair_name;                      /**< Имя валютной пары */
+        std::vector<std::string> currencies;        /**< Валюты новостей */
+        int min_level_volatility = LOW;             /**< Минимальный уровень силы новости */
+        uint8_t flags = 0;                          /**< Флаги фильтра */
+
+        StoreRequest() {};
+
+        /** \brief Записать запрос в кадр
+         * \param writer Запись кадра
+         */
+        void encode(StoreProtocol::Writer &writer) const {
+            writer.write(command);
+            switch(command) {
+            case StoreProtocol::CMD_GET:
+                writer.write((uint64_t)timestamp);
+                writer.write((uint64_t)indent_past);
+                writer.write((uint64_t)indent_future);
+                break;
+            case StoreProtocol::CMD_FILTER:
+                writer.write_str(pair_name);
+                writer.write((uint64_t)timestamp);
+                writer.write((uint64_t)indent_past);
+                writer.write((uint64_t)indent_future);
+                writer.write(flags);
+                break;
+            case StoreProtocol::CMD_NEXT_EVENT:
+            case StoreProtocol::CMD_PREV_EVENT:
+                writer.write((uint64_t)timestamp);
+                writer.write((int8_t)min_level_volatility);
+                writer.write((uint16_t)currencies.size());
+                for(size_t i = 0; i < currencies.size(); ++i) writer.write_str(currencies[i]);
+                break;
+            default:
+                break;
+            }
+        }
+
+        /** \brief Прочитать запрос из кадра
+         * \param reader Чтение кадра
+         * \return Вернет true в случае успеха
+         */
+        bool decode(StoreProtocol::Reader &reader) {
+            uint64_t value_timestamp = 0, value_past = 0, value_future = 0;
+            int8_t level_volatility = 0;
+            uint16_t num_currencies = 0;
+            if(!reader.read(command)) return false;
+            switch(command) {
+            case StoreProtocol::CMD_GET:
+                if(!reader.read(value_timestamp) || !reader.read(value_past) || !reader.read(value_future)) return false;
+                break;
+            case StoreProtocol::CMD_FILTER:
+                if(!reader.read_str(pair_name) ||
+                    !reader.read(value_timestamp) ||
+                    !reader.read(value_past) ||
+                    !reader.read(value_future) ||
+                    !reader.read(flags)) return false;
+                break;
+            case StoreProtocol::CMD_NEXT_EVENT:
+            case StoreProtocol::CMD_PREV_EVENT:
+                if(!reader.read(value_timestamp) || !reader.read(level_volatility) || !reader.read(num_currencies)) return false;
+                currencies.resize(num_currencies);
+                for(size_t i = 0; i < currencies.size(); ++i) {
+                    if(!reader.read_str(currencies[i])) return false;
+                }
+                min_level_volatility = level_volatility;
+                break;
+            case StoreProtocol::CMD_MIN_MAX:
+                break;
+            default:
+                return false;
+            }
+            timestamp = value_timestamp;
+            indent_past = value_past;
+            indent_future = value_future;
+            return true;
+        }
+    };
+
+    /** \brief Ответ сервера хранилища
+     */
+    class StoreResponse {
+    public:
+        int err = NO_DATA_ACCESS;                   /**< Код ошибки */
+        int state = NO_NEWS;                        /**< Состояние фильтра (CMD_FILTER) */
+        std::vector<News> list_news;                /**< Список новостей (CMD_GET) */
+        News news;                                  /**< Найденное событие (CMD_NEXT_EVENT, CMD_PREV_EVENT) */
+        xtime::timestamp_t min_timestamp = 0;       /**< Метка времени первого дня (CMD_MIN_MAX) */
+        xtime::timestamp_t max_timestamp = 0;       /**< Метка времени последнего дня (CMD_MIN_MAX) */
+
+        StoreResponse() {};
+
+        /** \brief Записать ответ в кадр
+         * \param command Команда запроса
+         * \param writer Запись кадра
+         */
+        void encode(const uint8_t command, StoreProtocol::Writer &writer) const {
+            writer.write((int32_t)err);
+            switch(command) {
+            case StoreProtocol::CMD_GET:
+                writer.write((uint32_t)list_news.size());
+                for(size_t i = 0; i < list_news.size(); ++i) writer.write_news(list_news[i]);
+                break;
+            case StoreProtocol::CMD_FILTER:
+                writer.write((int32_t)state);
+                break;
+            case StoreProtocol::CMD_NEXT_EVENT:
+            case StoreProtocol::CMD_PREV_EVENT:
+                if(err == OK) writer.write_news(news);
+                break;
+            case StoreProtocol::CMD_MIN_MAX:
+                writer.write((uint64_t)min_timestamp);
+                writer.write((uint64_t)max_timestamp);
+                break;
+            default:
+                break;
+            }
+        }
+
+        /** \brief Прочитать ответ из кадра
+         * \param command Команда запроса
+         * \param reader Чтение кадра
+         * \return Вернет true в случае успеха
+         */
+        bool decode(const uint8_t command, StoreProtocol::Reader &reader) {
+            int32_t value_err = 0, value_state = 0;
+            uint32_t num_news = 0;
+            uint64_t value_min = 0, value_max = 0;
+            if(!reader.read(value_err)) return false;
+            err = value_err;
+            switch(command) {
+            case StoreProtocol::CMD_GET:
+                if(!reader.read(num_news)) return false;
+                list_news.resize(num_news);
+                for(size_t i = 0; i < list_news.size(); ++i) {
+                    if(!reader.read_news(list_news[i])) return false;
+                }
+                break;
+            case StoreProtocol::CMD_FILTER:
+                if(!reader.read(value_state)) return false;
+                state = value_state;
+                break;
+            case StoreProtocol::CMD_NEXT_EVENT:
+            case StoreProtocol::CMD_PREV_EVENT:
+                if(err == OK && !reader.read_news(news)) return false;
+                break;
+            case StoreProtocol::CMD_MIN_MAX:
+                if(!reader.read(value_min) || !reader.read(value_max)) return false;
+                min_timestamp = value_min;
+                max_timestamp = value_max;
+                break;
+            default:
+                return false;
+            }
+            return true;
+        }
+    };
+
+    /** \brief Пакет запросов к серверу хранилища
+     *
+     * Все запросы пакета передаются одним кадром и обрабатываются сервером за один проход.
+     */
+    class StoreRequestBatch {
+    public:
+        std::vector<StoreRequest> requests;         /**< Запросы пакета */
+
+        StoreRequestBatch() {};
+
+        void clear() {
+            requests.clear();
+        }
+
+        size_t size() const {
+            return requests.size();
+        }
+
+        /** \brief Добавить запрос новостей, аналог DataStore::get
+         * \param timestamp Метка времени
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         */
+        void add_get(
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future) {
+            StoreRequest request;
+            request.command = StoreProtocol::CMD_GET;
+            request.timestamp = timestamp;
+            request.indent_past = indent_timestamp_past;
+            request.indent_future = indent_timestamp_future;
+            requests.push_back(request);
+        }
+
+        /** \brief Добавить запрос фильтра, аналог DataStore::filter
+         * \param pair_name Имя валютной пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param is_only_select Использовать только выбранные уровни силы новости.
+         * \param is_low Использовать слабые новости.
+         * \param is_moderate Использовать новости средней силы.
+         * \param is_high Использовать сильные новости.
+         */
+        void add_filter(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high) {
+            StoreRequest request;
+            request.command = StoreProtocol::CMD_FILTER;
+            request.pair_name = pair_name;
+            request.timestamp = timestamp;
+            request.indent_past = indent_timestamp_past;
+            request.indent_future = indent_timestamp_future;
+            if(is_only_select) request.flags |= StoreProtocol::FLAG_ONLY_SELECT;
+            if(is_low) request.flags |= StoreProtocol::FLAG_LOW;
+            if(is_moderate) request.flags |= StoreProtocol::FLAG_MODERATE;
+            if(is_high) request.flags |= StoreProtocol::FLAG_HIGH;
+            requests.push_back(request);
+        }
+
+        /** \brief Добавить поиск следующего события, аналог DataStore::next_event
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         */
+        void add_next_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility) {
+            StoreRequest request;
+            request.command = StoreProtocol::CMD_NEXT_EVENT;
+            request.timestamp = timestamp;
+            request.currencies = currencies;
+            request.min_level_volatility = min_level_volatility;
+            requests.push_back(request);
+        }
+
+        /** \brief Добавить поиск предыдущего события, аналог DataStore::prev_event
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         */
+        void add_prev_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility) {
+            add_next_event(timestamp, currencies, min_level_volatility);
+            requests.back().command = StoreProtocol::CMD_PREV_EVENT;
+        }
+
+        /** \brief Добавить запрос диапазона дат хранилища
+         */
+        void add_min_max() {
+            StoreRequest request;
+            request.command = StoreProtocol::CMD_MIN_MAX;
+            requests.push_back(request);
+        }
+    };
+
+#   if !defined(_WIN32)
+    /** \brief Отправить часть данных в сокет
+     *
+     * Для неблокирующего сокета метод не ждет, пока в сокете освободится место.
+     * \param fd Сокет
+     * \param data Данные
+     * \param size Размер данных
+     * \return Количество отправленных байтов, 0 если сокет сейчас не принимает данные, или -1 при ошибке
+     */
+    inline ssize_t store_socket_send_some(const int fd, const char *data, const size_t size) {
+#       if defined(MSG_NOSIGNAL)
+        const int send_flags = MSG_NOSIGNAL;
+#       else
+        const int send_flags = 0;
+#       endif
+        while(true) {
+            const ssize_t n = ::send(fd, data, size, send_flags);
+            if(n < 0 && errno == EINTR) continue;
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+            if(n <= 0) return -1;
+            return n;
+        }
+    }
+
+    /** \brief Отправить все данные в сокет
+     * \param fd Блокирующий сокет
+     * \param data Данные
+     * \return Вернет true в случае успеха
+     */
+    inline bool store_socket_send(const int fd, const std::string &data) {
+        size_t pos = 0;
+        while(pos < data.size()) {
+            const ssize_t n = store_socket_send_some(fd, data.data() + pos, data.size() - pos);
+            if(n <= 0) return false;
+            pos += (size_t)n;
+        }
+        return true;
+    }
+
+    /** \brief Сервер хранилища новостей
+     *
+     * Сервер владеет хранилищем и его кэшами (окно новостей, индекс событий) и отвечает
+     * на запросы клиентов через Unix domain socket. Все запросы обрабатываются одним потоком,
+     * поэтому хранилище не требует блокировок, а кэш остается общим для всех клиентов
+     * и не теряется при их перезапуске. Сокеты клиентов неблокирующие: ответ, который клиент
+     * еще не забрал, ждет в буфере подключения, и пока он не отправлен, новые запросы этого клиента
+     * не обрабатываются, поэтому медленный клиент не задерживает остальных.
+     * Доступен только на POSIX системах.
+     */
+    class StoreServer {
+    private:
+        /// Подключение клиента
+        class Connection {
+        public:
+            int fd = -1;
+            std::string input;                      /**< Принятые, но еще не обработанные данные */
+            std::string output;                     /**< Ответ, который еще не отправлен целиком */
+            size_t output_pos = 0;                  /**< Количество уже отправленных байтов ответа */
+
+            /** \brief Проверить, есть ли неотправленный ответ
+             * \return Вернет true, если часть ответа еще не отправлена
+             */
+            bool is_output() const {
+                return output_pos < output.size();
+            }
+        };
+
+        DataStore &store_;
+        int listen_fd_ = -1;
+        std::string socket_path_;
+        std::vector<Connection> connections_;
+        std::atomic<bool> is_stop_;
+        uint32_t update_period_ms_ = 0;             /**< Период вызова DataStore::update */
+        const int POLL_TIMEOUT_MS = 100;            /**< Максимальное время ожидания событий сокетов */
+
+        StoreServer(const StoreServer&) = delete;
+        StoreServer& operator=(const StoreServer&) = delete;
+
+        /** \brief Выполнить запрос
+         * \param request Запрос
+         * \param response Ответ
+         */
+        void process(const StoreRequest &request, StoreResponse &response) {
+            response.err = OK;
+            response.state = NO_NEWS;
+            switch(request.command) {
+            case StoreProtocol::CMD_GET:
+                response.list_news.clear();
+                response.err = store_.get(request.timestamp, request.indent_past, request.indent_future, response.list_news);
+                break;
+            case StoreProtocol::CMD_FILTER:
+                response.err = store_.filter(
+                    request.pair_name,
+                    request.timestamp,
+                    request.indent_past,
+                    request.indent_future,
+                    (request.flags & StoreProtocol::FLAG_ONLY_SELECT) != 0,
+                    (request.flags & StoreProtocol::FLAG_LOW) != 0,
+                    (request.flags & StoreProtocol::FLAG_MODERATE) != 0,
+                    (request.flags & StoreProtocol::FLAG_HIGH) != 0,
+                    response.state);
+                break;
+            case StoreProtocol::CMD_NEXT_EVENT:
+                response.err = store_.next_event(request.timestamp, request.currencies, request.min_level_volatility, response.news);
+                break;
+            case StoreProtocol::CMD_PREV_EVENT:
+                response.err = store_.prev_event(request.timestamp, request.currencies, request.min_level_volatility, response.news);
+                break;
+            case StoreProtocol::CMD_MIN_MAX:
+                response.err = store_.get_min_max_timestamp(response.min_timestamp, response.max_timestamp);
+                break;
+            default:
+                response.err = INVALID_PARAMETER;
+                break;
+            }
+        }
+
+        /** \brief Отправить неотправленный ответ подключения
+         *
+         * Метод не ждет: то, что не поместилось в сокет, будет отправлено, когда в нем освободится место.
+         * \param connection Подключение клиента
+         * \return Вернет false, если подключение нужно закрыть
+         */
+        static bool send_output(Connection &connection) {
+            while(connection.is_output()) {
+                const ssize_t n = store_socket_send_some(
+                    connection.fd,
+                    connection.output.data() + connection.output_pos,
+                    connection.output.size() - connection.output_pos);
+                if(n < 0) return false;
+                if(n == 0) return true;
+                connection.output_pos += (size_t)n;
+            }
+            connection.output.clear();
+            connection.output_pos = 0;
+            return true;
+        }
+
+        /** \brief Обработать полные кадры подключения
+         *
+         * Пока клиент не забрал предыдущий ответ, следующие кадры остаются в буфере подключения.
+         * \param connection Подключение клиента
+         * \return Вернет false, если подключение нужно закрыть
+         */
+        bool process_connection(Connection &connection) {
+            StoreRequest request;
+            StoreResponse response;
+            std::string &output = connection.output;
+            size_t pos = 0;
+            while(!connection.is_output() && connection.input.size() - pos >= StoreProtocol::FRAME_HEADER_SIZE) {
+                uint32_t size = 0, count = 0;
+                if(!StoreProtocol::parse_frame_header(connection.input.data() + pos, size, count)) return false;
+                if(connection.input.size() - pos - StoreProtocol::FRAME_HEADER_SIZE < size) break;
+                StoreProtocol::Reader reader(connection.input.data() + pos + StoreProtocol::FRAME_HEADER_SIZE, size);
+                StoreProtocol::begin_frame(output);
+                StoreProtocol::Writer writer(output);
+                for(uint32_t i = 0; i < count; ++i) {
+                    if(!request.decode(reader)) return false;
+                    process(request, response);
+                    const size_t response_pos = output.size();
+                    response.encode(request.command, writer);
+                    if(output.size() - StoreProtocol::FRAME_HEADER_SIZE > (size_t)StoreProtocol::MAX_FRAME_SIZE) {
+                        /* ответ не помещается в кадр, вместо него клиент получит код ошибки */
+                        output.resize(response_pos);
+                        response.err = INVALID_PARAMETER;
+                        response.list_news.clear();
+                        response.encode(request.command, writer);
+                        if(output.size() - StoreProtocol::FRAME_HEADER_SIZE > (size_t)StoreProtocol::MAX_FRAME_SIZE) return false;
+                    }
+                }
+                if(!reader.is_end()) return false;
+                StoreProtocol::end_frame(output, count);
+                pos += StoreProtocol::FRAME_HEADER_SIZE + size;
+                if(!send_output(connection)) return false;
+            }
+            connection.input.erase(0, pos);
+            return true;
+        }
+
+    public:
+
+        /** \brief Сервер хранилища
+         * \param store Хранилище новостей, должно существовать, пока работает сервер
+         */
+        StoreServer(DataStore &store) : store_(store) {
+            is_stop_ = false;
+        }
+
+        ~StoreServer() {
+            close();
+        }
+
+        /** \brief Установить период подхвата новых дней из журнала записи
+         *
+         * Имеет смысл, если для хранилища включен журнал записи (DataStore::set_write_log).
+         * \param period_ms Период в миллисекундах. Если 0, журнал не проверяется
+         */
+        void set_update_period(const uint32_t period_ms) {
+            update_period_ms_ = period_ms;
+        }
+
+        /** \brief Открыть сокет сервера
+         *
+         * Если файл сокета уже существует, он будет удален.
+         * \param socket_path Путь к файлу сокета
+         * \return Вернет 0 в случае успеха
+         */
+        int listen(const std::string &socket_path) {
+            close();
+            struct sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            if(socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) return INVALID_PARAMETER;
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+            ::unlink(socket_path.c_str());
+            listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if(listen_fd_ < 0) return NO_DATA_ACCESS;
+            if(::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                ::listen(listen_fd_, SOMAXCONN) != 0) {
+                ::close(listen_fd_);
+                listen_fd_ = -1;
+                return NO_DATA_ACCESS;
+            }
+            socket_path_ = socket_path;
+            return OK;
+        }
+
+        /** \brief Закрыть сокет сервера и все подключения
+         */
+        void close() {
+            for(size_t i = 0; i < connections_.size(); ++i) ::close(connections_[i].fd);
+            connections_.clear();
+            if(listen_fd_ >= 0) {
+                ::close(listen_fd_);
+                ::unlink(socket_path_.c_str());
+            }
+            listen_fd_ = -1;
+            socket_path_.clear();
+        }
+
+        /** \brief Обслуживать клиентов до вызова stop()
+         * \return Вернет 0 в случае успеха
+         */
+        int run() {
+            if(listen_fd_ < 0) return NO_DATA_ACCESS;
+            is_stop_ = false;
+            std::vector<struct pollfd> fds;
+            std::vector<char> buffer(64 * 1024);
+            auto last_update = std::chrono::steady_clock::now();
+            while(!is_stop_) {
+                fds.resize(connections_.size() + 1);
+                fds[0].fd = listen_fd_;
+                fds[0].events = POLLIN;
+                fds[0].revents = 0;
+                for(size_t i = 0; i < connections_.size(); ++i) {
+                    fds[i + 1].fd = connections_[i].fd;
+                    /* пока ответ не отправлен, новые запросы клиента не читаются */
+                    fds[i + 1].events = connections_[i].is_output() ? POLLOUT : POLLIN;
+                    fds[i + 1].revents = 0;
+                }
+                const int num_events = ::poll(fds.data(), fds.size(), POLL_TIMEOUT_MS);
+                if(update_period_ms_ > 0) {
+                    const auto now = std::chrono::steady_clock::now();
+                    if(now - last_update >= std::chrono::milliseconds(update_period_ms_)) {
+                        store_.update();
+                        last_update = now;
+                    }
+                }
+                if(num_events <= 0) continue;
+
+                /* сначала читаем данные существующих подключений, затем принимаем новые */
+                for(size_t i = connections_.size(); i > 0; --i) {
+                    if(fds[i].revents == 0) continue;
+                    Connection &connection = connections_[i - 1];
+                    bool is_close = false;
+                    if(connection.is_output()) {
+                        /* допишем ответ и обработаем запросы, которые ждали его отправки */
+                        is_close = !send_output(connection) || !process_connection(connection);
+                    } else {
+                        const ssize_t n = ::recv(connection.fd, buffer.data(), buffer.size(), 0);
+                        is_close = n <= 0 && !(n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK));
+                        if(n > 0) {
+                            connection.input.append(buffer.data(), (size_t)n);
+                            is_close = !process_connection(connection);
+                        }
+                    }
+                    if(is_close) {
+                        ::close(connection.fd);
+                        connections_.erase(connections_.begin() + (i - 1));
+                    }
+                }
+                if(fds[0].revents & POLLIN) {
+                    const int fd = ::accept(listen_fd_, NULL, NULL);
+                    if(fd >= 0) {
+                        /* сокет клиента неблокирующий, чтобы медленный клиент не останавливал сервер */
+                        if(::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+                            ::close(fd);
+                        } else {
+                            Connection connection;
+                            connection.fd = fd;
+                            connections_.push_back(connection);
+                        }
+                    }
+                }
+            }
+            return OK;
+        }
+
+        /** \brief Остановить цикл run()
+         *
+         * Метод можно вызвать из другого потока или из обработчика сигнала.
+         */
+        void stop() {
+            is_stop_ = true;
+        }
+    };
+
+    /** \brief Клиент сервера хранилища новостей
+     *
+     * Методы повторяют интерфейс DataStore, но выполняются на сервере.
+     * Несколько запросов можно отправить одним пакетом методом execute.
+     * Доступен только на POSIX системах.
+     */
+    class StoreClient {
+    private:
+        int fd_ = -1;
+        std::string output_;
+        std::string input_;
+        StoreRequestBatch batch_;
+        std::vector<StoreResponse> responses_;
+
+        StoreClient(const StoreClient&) = delete;
+        StoreClient& operator=(const StoreClient&) = delete;
+
+        bool recv_all(std::string &data, const size_t size) {
+            data.resize(size);
+            size_t pos = 0;
+            while(pos < size) {
+                const ssize_t n = ::recv(fd_, &data[pos], size - pos, 0);
+                if(n < 0 && errno == EINTR) continue;
+                if(n <= 0) return false;
+                pos += (size_t)n;
+            }
+            return true;
+        }
+
+        /** \brief Выполнить один запрос из batch_
+         * \return Вернет код ошибки запроса или ошибку соединения
+         */
+        int execute_single() {
+            int err = execute(batch_, responses_);
+            if(err != OK) return err;
+            return responses_[0].err;
+        }
+
+    public:
+
+        StoreClient() {};
+
+        /** \brief Подключиться к серверу
+         * \param socket_path Путь к файлу сокета
+         */
+        StoreClient(const std::string &socket_path) {
+            connect(socket_path);
+        }
+
+        ~StoreClient() {
+            close();
+        }
+
+        /** \brief Подключиться к серверу
+         * \param socket_path Путь к файлу сокета
+         * \return Вернет 0 в случае успеха
+         */
+        int connect(const std::string &socket_path) {
+            close();
+            struct sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            if(socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) return INVALID_PARAMETER;
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+            fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if(fd_ < 0) return NO_DATA_ACCESS;
+            if(::connect(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            return OK;
+        }
+
+        /** \brief Отключиться от сервера
+         */
+        void close() {
+            if(fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+        }
+
+        /** \brief Проверить подключение
+         * \return Вернет true, если клиент подключен
+         */
+        bool is_connected() const {
+            return fd_ >= 0;
+        }
+
+        /** \brief Выполнить пакет запросов
+         *
+         * При ошибке соединения клиент отключается. Пакет, который не помещается в один кадр
+         * (StoreProtocol::MAX_FRAME_SIZE), не отправляется, метод вернет INVALID_PARAMETER.
+         * \param batch Пакет запросов
+         * \param responses Ответы в порядке запросов
+         * \return Вернет 0, если все ответы получены. Коды ошибок отдельных запросов лежат в ответах
+         */
+        int execute(const StoreRequestBatch &batch, std::vector<StoreResponse> &responses) {
+            if(fd_ < 0) return NO_DATA_ACCESS;
+            StoreProtocol::begin_frame(output_);
+            StoreProtocol::Writer writer(output_);
+            for(size_t i = 0; i < batch.requests.size(); ++i) batch.requests[i].encode(writer);
+            if(output_.size() - StoreProtocol::FRAME_HEADER_SIZE > (size_t)StoreProtocol::MAX_FRAME_SIZE) return INVALID_PARAMETER;
+            StoreProtocol::end_frame(output_, (uint32_t)batch.requests.size());
+            if(!store_socket_send(fd_, output_) || !recv_all(input_, StoreProtocol::FRAME_HEADER_SIZE)) {
+                close();
+                return NO_DATA_ACCESS;
+            }
+            uint32_t size = 0, count = 0;
+            if(!StoreProtocol::parse_frame_header(input_.data(), size, count) ||
+                count != batch.requests.size() ||
+                !recv_all(input_, size)) {
+                close();
+                return PARSER_ERROR;
+            }
+            StoreProtocol::Reader reader(input_.data(), input_.size());
+            responses.resize(count);
+            for(size_t i = 0; i < responses.size(); ++i) {
+                if(!responses[i].decode(batch.requests[i].command, reader)) {
+                    close();
+                    return PARSER_ERROR;
+                }
+            }
+            return OK;
+        }
+
+        /** \brief Получить метки времени начала и конца хранилища
+         * \param min_timestamp Метка времени первого дня
+         * \param max_timestamp Метка времени последнего дня
+         * \return Вернет 0 в случае успеха
+         */
+        int get_min_max_timestamp(xtime::timestamp_t &min_timestamp, xtime::timestamp_t &max_timestamp) {
+            batch_.clear();
+            batch_.add_min_max();
+            int err = execute_single();
+            if(err != OK) return err;
+            min_timestamp = responses_[0].min_timestamp;
+            max_timestamp = responses_[0].max_timestamp;
+            return OK;
+        }
+
+        /** \brief Получить новости
+         * \param timestamp Метка времени
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param news_data Список новостей
+         * \return Вернет 0 в случае отсутствия ошибок
+         */
+        int get(
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                std::vector<News> &news_data) {
+            batch_.clear();
+            batch_.add_get(timestamp, indent_timestamp_past, indent_timestamp_future);
+            int err = execute_single();
+            if(!responses_.empty()) news_data.swap(responses_[0].list_news);
+            return err;
+        }
+
+        /** \brief Фильтр новостей
+         * \param pair_name имя валютной пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param is_only_select Использовать только выбранные уровни силы новости.
+         * \param is_low Использовать слабые новости.
+         * \param is_moderate Использовать новости средней силы.
+         * \param is_high Использовать сильные новости.
+         * \param state состояние фильтра (NEWS_FOUND или NO_NEWS)
+         * \return вернет 0 в случае успеха
+         */
+        int filter(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high,
+                int &state) {
+            state = NO_NEWS;
+            batch_.clear();
+            batch_.add_filter(
+                pair_name,
+                timestamp,
+                indent_timestamp_past,
+                indent_timestamp_future,
+                is_only_select,
+                is_low,
+                is_moderate,
+                is_high);
+            int err = execute_single();
+            if(err == OK) state = responses_[0].state;
+            return err;
+        }
+
+        /** \brief Фильтр новостей
+         * \param pair_name имя валютной пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param state состояние фильтра (NEWS_FOUND или NO_NEWS)
+         * \return вернет 0 в случае успеха
+         */
+        int filter(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const int min_level_volatility,
+                int &state) {
+            return filter(
+                pair_name,
+                timestamp,
+                indent_timestamp_past,
+                indent_timestamp_future,
+                false,
+                min_level_volatility <= LOW,
+                min_level_volatility <= MODERATE,
+                min_level_volatility <= HIGH,
+                state);
+        }
+
+        /** \brief Проверить новости
+         * \param pair_name имя валютной пары
+         * \param timestamp Текущее время (Метка времени)
+         * \param indent_timestamp_past Максимальный отступ до метки времени
+         * \param indent_timestamp_future Максимальный отступ после метки времени
+         * \param is_only_select Использовать только выбранные уровни силы новости.
+         * \param is_low Использовать слабые новости.
+         * \param is_moderate Использовать новости средней силы.
+         * \param is_high Использовать сильные новости.
+         * \return вернет true если есть новость, подходящая по указанным параметрам
+         */
+        bool is_news(
+                const std::string &pair_name,
+                const xtime::timestamp_t timestamp,
+                const xtime::timestamp_t indent_timestamp_past,
+                const xtime::timestamp_t indent_timestamp_future,
+                const bool is_only_select,
+                const bool is_low,
+                const bool is_moderate,
+                const bool is_high) {
+            int state = NO_NEWS;
+            int err = filter(
+                pair_name,
+                timestamp,
+                indent_timestamp_past,
+                indent_timestamp_future,
+                is_only_select,
+                is_low,
+                is_moderate,
+                is_high,
+                state);
+            return (err == OK && state == NEWS_FOUND);
+        }
+
+        /** \brief Найти следующее событие
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param news Первая подходящая новость строго после timestamp
+         * \return Вернет 0 в случае успеха
+         */
+        int next_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            batch_.clear();
+            batch_.add_next_event(timestamp, currencies, min_level_volatility);
+            int err = execute_single();
+            if(err == OK) news = responses_[0].news;
+            return err;
+        }
+
+        /** \brief Найти предыдущее событие
+         * \param timestamp Метка времени
+         * \param currencies Валюты новостей. Если список пуст, подходят все валюты
+         * \param min_level_volatility Минимальный уровень силы новости (от 0 до 2)
+         * \param news Последняя подходящая новость не позже timestamp
+         * \return Вернет 0 в случае успеха
+         */
+        int prev_event(
+                const xtime::timestamp_t timestamp,
+                const std::vector<std::string> &currencies,
+                const int min_level_volatility,
+                News &news) {
+            batch_.clear();
+            batch_.add_prev_event(timestamp, currencies, min_level_volatility);
+            int err = execute_single();
+            if(err == OK) news = responses_[0].news;
+            return err;
+        }
+    };
+#   endif
+}
+#endif // FOREXPROSTOOLS_STORE_SERVER_HPP_INCLUDED
@@ -0,0 +1,232 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_SURPRISE_INDEX_HPP_INCLUDED
+#define FOREXPROSTOOLS_SURPRISE_INDEX_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <unordered_set>
+#include <cmath>
+//------------------------------------------------------------------------------
+namespace ForexprostoolsApiEasy {
+
+    /** \brief Производные показатели новости
+     */
+    class SurpriseMetrics {
+    public:
+        xtime::timestamp_t timestamp = 0;   /**< Метка времени новости */
+        double surprise = 0.0;              /**< Отклонение от прогноза (actual - forecast) */
+        double change = 0.0;                /**< Изменение (actual - previous) */
+        double z_score = 0.0;               /**< Отклонение от прогноза, нормированное по истории этой новости */
+        uint32_t num_history = 0;           /**< Количество прошлых отклонений от прогноза, по которым посчитан z_score */
+        bool is_surprise = false;           /**< Наличие отклонения от прогноза */
+        bool is_change = false;             /**< Наличие изменения */
+        bool is_z_score = false;            /**< Наличие нормированного отклонения */
+
+        SurpriseMetrics() {};
+    };
+
+    /** \brief Индекс производных показателей новостей
+     *
+     * Новости группируются в ряды по имени и валюте. Для каждой новости ряда заранее считаются
+     * отклонение от прогноза, изменение и z-оценка отклонения по прошлым новостям ряда
+     * (будущие значения в оценку не попадают). При изменении дня пересчитываются только ряды,
+     * в которые входят новости этого дня.
+     */
+    class SurpriseIndex {
+    private:
+        std::unordered_map<std::string, std::vector<SurpriseMetrics>> series_;          /**< Ряды показателей */
+        std::unordered_map<uint32_t, std::vector<std::string>> day_series_;             /**< Ряды, в которые входят новости дня */
+        std::unordered_set<std::string> dirty_series_;                                  /**< Ряды, которые нужно пересчитать */
+
+        inline static uint32_t get_day(const xtime::timestamp_t timestamp) {
+            return (uint32_t)(timestamp / xtime::SECONDS_IN_DAY);
+        }
+
+        /** \brief Пересчитать z-оценки ряда
+         * \param list Ряд показателей, отсортированный по времени
+         */
+        static void update_z_score(std::vector<SurpriseMetrics> &list) {
+            /* среднее и дисперсия считаются по прошлым отклонениям (алгоритм Уэлфорда) */
+            uint32_t num = 0;
+            double mean = 0.0, m2 = 0.0;
+            for(size_t i = 0; i < list.size(); ++i) {
+                SurpriseMetrics &metrics = list[i];
+                metrics.num_history = num;
+                metrics.is_z_score = false;
+                metrics.z_score = 0.0;
+                if(!metrics.is_surprise) continue;
+                if(num >= 2) {
+                    const double std_dev = std::sqrt(m2 / (double)(num - 1));
+                    if(std_dev > 0.0) {
+                        metrics.z_score = (metrics.surprise - mean) / std_dev;
+                        metrics.is_z_score = true;
+                    }
+                }
+                ++num;
+                const double delta = metrics.surprise - mean;
+                mean += delta / (double)num;
+                m2 += delta * (metrics.surprise - mean);
+            }
+        }
+
+    public:
+
+        SurpriseIndex() {};
+
+        /** \brief Получить ключ ряда
+         * \param name Имя новости
+         * \param currency Валюта новости
+         * \return Ключ ряда
+         */
+        inline static std::string get_key(const std::string &name, const std::string &currency) {
+            std::string key;
+            key.reserve(name.size() + currency.size() + 1);
+            key += currency;
+            key += '\x1f';
+            key += name;
+            return key;
+        }
+
+        /** \brief Очистить индекс
+         */
+        void clear() {
+            series_.clear();
+            day_series_.clear();
+            dirty_series_.clear();
+        }
+
+        /** \brief Удалить новости дня
+         * \param day_timestamp Метка времени начала дня
+         */
+        void remove_day(const xtime::timestamp_t day_timestamp) {
+            auto it_day = day_series_.find(get_day(day_timestamp));
+            if(it_day == day_series_.end()) return;
+            const xtime::timestamp_t end_timestamp = day_timestamp + xtime::SECONDS_IN_DAY;
+            auto compare = [](const SurpriseMetrics &lhs, const xtime::timestamp_t rhs) {
+                return lhs.timestamp < rhs;
+            };
+            for(size_t i = 0; i < it_day->second.size(); ++i) {
+                auto it = series_.find(it_day->second[i]);
+                if(it == series_.end()) continue;
+                std::vector<SurpriseMetrics> &list = it->second;
+                list.erase(
+                    std::lower_bound(list.begin(), list.end(), day_timestamp, compare),
+                    std::lower_bound(list.begin(), list.end(), end_timestamp, compare));
+                dirty_series_.insert(it->first);
+            }
+            day_series_.erase(it_day);
+        }
+
+        /** \brief Добавить новости дня
+         *
+         * Перед повторным добавлением дня его нужно удалить методом remove_day
+         * \param day_timestamp Метка времени начала дня
+         * \param list_news Новости дня
+         */
+        void add_day(const xtime::timestamp_t day_timestamp, const std::vector<News> &list_news) {
+            std::vector<std::string> &keys = day_series_[get_day(day_timestamp)];
+            for(size_t i = 0; i < list_news.size(); ++i) {
+                const News &news = list_news[i];
+                if(!news.is_actual && !news.is_forecast && !news.is_previous) continue;
+                SurpriseMetrics metrics;
+                metrics.timestamp = news.timestamp;
+                if(news.is_actual && news.is_forecast) {
+                    metrics.surprise = news.actual - news.forecast;
+                    metrics.is_surprise = true;
+                }
+                if(news.is_actual && news.is_previous) {
+                    metrics.change = news.actual - news.previous;
+                    metrics.is_change = true;
+                }
+                const std::string key = get_key(news.name, news.currency);
+                std::vector<SurpriseMetrics> &list = series_[key];
+                if(list.empty() || list.back().timestamp <= metrics.timestamp) {
+                    list.push_back(metrics);
+                } else {
+                    auto it = std::upper_bound(list.begin(), list.end(), metrics.timestamp,
+                        [](const xtime::timestamp_t lhs, const SurpriseMetrics &rhs) {
+                        return lhs < rhs.timestamp;
+                    });
+                    list.insert(it, metrics);
+                }
+                if(std::find(keys.begin(), keys.end(), key) == keys.end()) keys.push_back(key);
+                dirty_series_.insert(key);
+            }
+            if(keys.empty()) day_series_.erase(get_day(day_timestamp));
+        }
+
+        /** \brief Пересчитать z-оценки измененных рядов
+         */
+        void update() {
+            for(auto it = dirty_series_.begin(); it != dirty_series_.end(); ++it) {
+                auto it_series = series_.find(*it);
+                if(it_series == series_.end()) continue;
+                if(it_series->second.empty()) {
+                    series_.erase(it_series);
+                    continue;
+                }
+                update_z_score(it_series->second);
+            }
+            dirty_series_.clear();
+        }
+
+        /** \brief Получить показатели новости
+         * \param timestamp Метка времени новости
+         * \param name Имя новости
+         * \param currency Валюта новости
+         * \param metrics Показатели новости
+         * \return Вернет true, если показатели найдены
+         */
+        bool get(
+                const xtime::timestamp_t timestamp,
+                const std::string &name,
+                const std::string &currency,
+                SurpriseMetrics &metrics) const {
+            auto it = series_.find(get_key(name, currency));
+            if(it == series_.end()) return false;
+            const std::vector<SurpriseMetrics> &list = it->second;
+            auto it_metrics = std::lower_bound(list.begin(), list.end(), timestamp,
+                [](const SurpriseMetrics &lhs, const xtime::timestamp_t rhs) {
+                return lhs.timestamp < rhs;
+            });
+            if(it_metrics == list.end() || it_metrics->timestamp != timestamp) return false;
+            metrics = *it_metrics;
+            return true;
+        }
+
+        /** \brief Получить ряд показателей новости
+         * \param name Имя новости
+         * \param currency Валюта новости
+         * \return Указатель на ряд показателей, отсортированный по времени, или nullptr
+         */
+        const std::vector<SurpriseMetrics> *get_series(
+                const std::string &name,
+                const std::string &currency) const {
+            auto it = series_.find(get_key(name, currency));
+            if(it == series_.end()) return nullptr;
+            return &it->second;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_SURPRISE_INDEX_HPP_INCLUDED
@@ -0,0 +1,342 @@
+/*
+* forexprostools-cpp-api - Forexprostools C++ API client
+*
+* Copyright (c) 2018 Elektro Yar. Email: git.electroyar@gmail.com
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+#ifndef FOREXPROSTOOLS_WRITE_LOG_HPP_INCLUDED
+#define FOREXPROSTOOLS_WRITE_LOG_HPP_INCLUDED
+//------------------------------------------------------------------------------
+#include <ForexprostoolsApiEasy.hpp>
+#include <fstream>
+#include <functional>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+//------------------------------------------------------------------------------
+namespace ForexprostoolsDataStore {
+
+    /** \brief Межпроцессная блокировка файла
+     *
+     * Блокировка может быть разделяемой (для читателей) или исключительной (для писателя).
+     */
+    class FileLock {
+    private:
+#       if defined(_WIN32)
+        HANDLE handle_ = INVALID_HANDLE_VALUE;
+#       else
+        int fd_ = -1;
+#       endif
+        bool is_lock_ = false;
+
+        FileLock(const FileLock&) = delete;
+        FileLock& operator=(const FileLock&) = delete;
+
+        bool lock(const bool is_exclusive) {
+            if(is_lock_) return true;
+#           if defined(_WIN32)
+            if(handle_ == INVALID_HANDLE_VALUE) return false;
+            OVERLAPPED overlapped;
+            ZeroMemory(&overlapped, sizeof(overlapped));
+            if(!LockFileEx(handle_, is_exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD, &overlapped)) return false;
+#           else
+            if(fd_ < 0) return false;
+            if(flock(fd_, is_exclusive ? LOCK_EX : LOCK_SH) != 0) return false;
+#           endif
+            is_lock_ = true;
+            return true;
+        }
+
+    public:
+
+        /** \brief Открыть файл блокировки
+         * \param file_name Имя файла блокировки. Файл будет создан, если его нет
+         */
+        FileLock(const std::string &file_name) {
+#           if defined(_WIN32)
+            handle_ = CreateFileA(
+                file_name.c_str(),
+                GENERIC_READ | GENERIC_WRITE,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                NULL,
+                OPEN_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL,
+                NULL);
+#           else
+            fd_ = ::open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+#           endif
+        }
+
+        ~FileLock() {
+            unlock();
+#           if defined(_WIN32)
+            if(handle_ != INVALID_HANDLE_VALUE) CloseHandle(handle_);
+#           else
+            if(fd_ >= 0) ::close(fd_);
+#           endif
+        }
+
+        /** \brief Проверить, открыт ли файл блокировки
+         * \return Вернет true, если файл блокировки открыт
+         */
+        bool is_open() const {
+#           if defined(_WIN32)
+            return handle_ != INVALID_HANDLE_VALUE;
+#           else
+            return fd_ >= 0;
+#           endif
+        }
+
+        /** \brief Захватить разделяемую блокировку
+         * \return Вернет true в случае успеха
+         */
+        bool lock_shared() {
+            return lock(false);
+        }
+
+        /** \brief Захватить исключительную блокировку
+         * \return Вернет true в случае успеха
+         */
+        bool lock_exclusive() {
+            return lock(true);
+        }
+
+        /** \brief Снять блокировку
+         */
+        void unlock() {
+            if(!is_lock_) return;
+#           if defined(_WIN32)
+            OVERLAPPED overlapped;
+            ZeroMemory(&overlapped, sizeof(overlapped));
+            UnlockFileEx(handle_, 0, MAXDWORD, MAXDWORD, &overlapped);
+#           else
+            flock(fd_, LOCK_UN);
+#           endif
+            is_lock_ = false;
+        }
+    };
+
+    /** \brief Захват блокировки файла на время жизни объекта
+     *
+     * Если блокировку захватить не удалось, is_lock() вернет false,
+     * и защищенные блокировкой действия выполнять нельзя.
+     */
+    class FileLockGuard {
+    private:
+        FileLock &lock_;
+        bool is_lock_ = false;
+    public:
+        FileLockGuard(FileLock &lock, const bool is_exclusive) : lock_(lock) {
+            is_lock_ = is_exclusive ? lock_.lock_exclusive() : lock_.lock_shared();
+        }
+
+        ~FileLockGuard() {
+            if(is_lock_) lock_.unlock();
+        }
+
+        /** \brief Проверить, захвачена ли блокировка
+         * \return Вернет true, если блокировка захвачена
+         */
+        bool is_lock() const {
+            return is_lock_;
+        }
+    };
+
+    /** \brief Журнал записи хранилища
+     *
+     * Журнал позволяет одному процессу-писателю дописывать дни в конец файла,
+     * пока другие процессы читают хранилище. Каждая запись содержит хеш данных,
+     * поэтому читатель, увидевший недописанную запись, просто дочитает ее позже.
+     * Когда писатель переносит журнал в хранилище, номер поколения журнала увеличивается,
+     * а файл журнала начинается заново.
+     */
+    class WriteLog {
+    private:
+        std::string file_name_;             /**< Имя файла журнала */
+        uint64_t generation_ = 0;           /**< Поколение журнала, прочитанное последним */
+        uint64_t offset_ = 0;               /**< Смещение первой непрочитанной записи */
+
+        enum {
+            MAGIC = 0x4C575046,             /**< Сигнатура файла журнала ("FPWL") */
+            RECORD_MAGIC = 0x52575046,      /**< Сигнатура записи журнала ("FPWR") */
+            HEADER_SIZE = 16,               /**< Размер заголовка файла журнала */
+            RECORD_HEADER_SIZE = 24,        /**< Размер заголовка записи */
+        };
+
+        template<class T>
+        static bool read_value(std::ifstream &file, T &value) {
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return (bool)file;
+        }
+
+        template<class T>
+        static void write_value(std::ofstream &file, const T &value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        /** \brief Прочитать поколение журнала
+         * \param file Файл журнала
+         * \param generation Поколение журнала
+         * \return Вернет true в случае успеха
+         */
+        static bool read_header(std::ifstream &file, uint64_t &generation) {
+            uint32_t magic = 0, reserved = 0;
+            if(!read_value(file, magic) || magic != MAGIC) return false;
+            if(!read_value(file, reserved)) return false;
+            return read_value(file, generation);
+        }
+
+    public:
+
+        WriteLog() {};
+
+        /** \brief Открыть журнал
+         * \param file_name Имя файла журнала
+         */
+        WriteLog(const std::string &file_name) : file_name_(file_name) {};
+
+        /** \brief Получить поколение журнала в файле
+         * \param generation Поколение журнала
+         * \return Вернет true, если журнал существует
+         */
+        bool get_generation(uint64_t &generation) const {
+            std::ifstream file(file_name_, std::ios::binary);
+            if(!file) return false;
+            return read_header(file, generation);
+        }
+
+        /** \brief Получить поколение журнала, прочитанное последним
+         * \return Поколение журнала
+         */
+        uint64_t get_read_generation() const {
+            return generation_;
+        }
+
+        /** \brief Запомнить поколение журнала как прочитанное
+         *
+         * Вызывается читателем, который узнал о смене поколения не через read().
+         * Записи нового поколения будут прочитаны с начала при следующем вызове read().
+         * \param generation Поколение журнала
+         */
+        void set_read_generation(const uint64_t generation) {
+            generation_ = generation;
+            offset_ = HEADER_SIZE;
+        }
+
+        /** \brief Проверить, что в журнале нет записей
+         * \return Вернет true, если файла журнала нет или в нем только заголовок
+         */
+        bool is_empty() const {
+            std::ifstream file(file_name_, std::ios::binary | std::ios::ate);
+            if(!file) return true;
+            return file.tellg() <= (std::streamoff)HEADER_SIZE;
+        }
+
+        /** \brief Начать журнал заново
+         *
+         * Вызывается писателем после переноса журнала в хранилище под исключительной блокировкой.
+         * \return Вернет true в случае успеха
+         */
+        bool reset() {
+            uint64_t generation = 0;
+            get_generation(generation);
+            ++generation;
+            std::ofstream file(file_name_, std::ios::binary | std::ios::trunc);
+            if(!file) return false;
+            write_value(file, (uint32_t)MAGIC);
+            write_value(file, (uint32_t)0);
+            write_value(file, generation);
+            file.flush();
+            if(!file) return false;
+            generation_ = generation;
+            offset_ = HEADER_SIZE;
+            return true;
+        }
+
+        /** \brief Дописать день в журнал
+         * \param timestamp Метка времени начала дня
+         * \param data Данные дня (JSON)
+         * \return Вернет true в случае успеха
+         */
+        bool append(const xtime::timestamp_t timestamp, const std::string &data) {
+            uint64_t generation = 0;
+            if(!get_generation(generation) && !reset()) return false;
+            std::ofstream file(file_name_, std::ios::binary | std::ios::app);
+            if(!file) return false;
+            write_value(file, (uint32_t)RECORD_MAGIC);
+            write_value(file, (uint32_t)data.size());
+            write_value(file, (uint64_t)timestamp);
+            write_value(file, ForexprostoolsApiEasy::get_hash(data));
+            file.write(data.data(), data.size());
+            file.flush();
+            return (bool)file;
+        }
+
+        /** \brief Прочитать новые записи журнала
+         *
+         * Читаются только полностью записанные записи.
+         * Если поколение журнала изменилось, журнал читается с начала.
+         * \param user_function Функция получит метку времени дня и данные дня
+         * \param is_new_generation Флаг смены поколения журнала
+         * \return Количество прочитанных записей
+         */
+        size_t read(
+                std::function<void(const xtime::timestamp_t timestamp, const std::string &data)> user_function,
+                bool &is_new_generation) {
+            is_new_generation = false;
+            std::ifstream file(file_name_, std::ios::binary);
+            if(!file) return 0;
+            uint64_t generation = 0;
+            if(!read_header(file, generation)) return 0;
+            if(generation != generation_ || offset_ < HEADER_SIZE) {
+                is_new_generation = generation != generation_;
+                generation_ = generation;
+                offset_ = HEADER_SIZE;
+            }
+            file.seekg(offset_);
+            size_t num_records = 0;
+            std::string data;
+            while(true) {
+                uint32_t magic = 0, size = 0;
+                uint64_t timestamp = 0, hash = 0;
+                if(!read_value(file, magic) || magic != RECORD_MAGIC) break;
+                if(!read_value(file, size) ||
+                    !read_value(file, timestamp) ||
+                    !read_value(file, hash)) break;
+                data.resize(size);
+                if(size > 0 && !file.read(&data[0], size)) break;
+                /* запись еще дописывается */
+                if(ForexprostoolsApiEasy::get_hash(data) != hash) break;
+                offset_ += RECORD_HEADER_SIZE + size;
+                user_function(timestamp, data);
+                ++num_records;
+            }
+            return num_records;
+        }
+    };
+}
+#endif // FOREXPROSTOOLS_WRITE_LOG_HPP_INCLUDED